@@ -5,26 +5,33 @@
 #include <limits>
 #include <cmath>
 
-#include "algorithm.hpp"
+#include "../geometry/hull.hpp"
+#include "../geometry/progress.hpp"
+#include "../render/layer.hpp"
+#include "../render/worker.hpp"
 
-std::vector< Point > points;
-std::vector< sf::Vertex > hull;
+// the algorithm itself is in geometry/hull.hpp, this only draws its input and output
+std::vector< convex::Point > points;
+Layer dots(2.f, 2.f, sf::Color::White, sf::Color::Blue);
+Layer hull_lines;
+
+// the hull is computed on a worker thread (on a copy of the points), the window picks it up when it's done
+typedef Worker< std::vector< convex::Point > > HullWorker;
+HullWorker worker;
 
 void make_hull(){
-    std::sort(points.begin(), points.end());
-    // hull = grahamScan(points.begin(), points.end());
-    int n = points.size();
-    int t = 0;
-    while(t<n){
-        int m = 1<<(1<<t); // 2^(2^t)
-        if(m>n){m = n;}
-        auto result = chan_algo(points, m);
-        if(!result.empty()){
-            hull = result;
-            return;
-        }
-        ++t;
-    }
+    worker.start([input = points](HullWorker& w){
+        progress::Scope scope([&](double){return !w.cancelled();});
+        auto result = convex::convex_hull(input);
+        if(result.empty() || w.cancelled()){return;}
+        w.draft() = std::move(result);
+        w.publish();
+    });
+}
+
+void show_hull(const std::vector< convex::Point >& result){
+    hull_lines.clear();
+    for(std::size_t i=0; i+1<result.size(); ++i){hull_lines.add(result[i].x, result[i].y, result[i+1].x, result[i+1].y);}
 }
 
 int main(){      
@@ -38,7 +45,9 @@ int main(){
             if (event.type == sf::Event::Closed){window.close();}
             if (event.type == sf::Event::MouseButtonPressed){
                 if(event.mouseButton.button == sf::Mouse::Left){
-                    points.push_back(Point(event.mouseButton.x, event.mouseButton.y));
+                    worker.stop();  // stale now
+                    points.push_back(convex::Point{(float)event.mouseButton.x, (float)event.mouseButton.y});
+                    dots.add(event.mouseButton.x, event.mouseButton.y);
                 }else
                 if(event.mouseButton.button == sf::Mouse::Right){
                     make_hull();
@@ -46,17 +55,21 @@ int main(){
             }
             if (event.type == sf::Event::KeyPressed){
                 if(event.key.code == sf::Keyboard::R){
+                    worker.stop();
                     points.clear();
-                    hull.clear();
+                    dots.clear();
+                    hull_lines.clear();
                 }
             }
         }
 
+        if(auto result = worker.latest()){show_hull(*result);}
+
         window.clear(sf::Color::Black);
-        for(auto p: points){window.draw(p);}
-        window.draw(&hull[0], hull.size(), sf::LineStrip);
+        window.draw(dots);
+        window.draw(hull_lines);
         window.display();
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,51 @@
+// memory for the node containers of the sweeps (event queues, status structures, the voronoi edge set), all std::pmr
+// the containers of one algorithm allocate through its SweepMemory, which passes everything on to the resource chosen
+// for the run: by default a monotonic arena that is dropped all at once when the next run starts (no malloc/free per
+// node, so no contention on the global heap when many runs share a process), or whatever the caller hands in instead
+// it also counts what goes through it, see stats()
+
+#pragma once
+
+#include <memory_resource>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+struct MemoryStats{
+    uint64_t allocations = 0;   // nodes (and the odd vector buffer) handed out during the run
+    uint64_t bytes = 0;         // their total size
+    uint64_t peak_bytes = 0;    // most bytes in use at once
+    uint64_t in_use = 0;
+};
+
+class SweepMemory : public std::pmr::memory_resource{
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::memory_resource* target = &arena;
+        MemoryStats counts;
+
+        void* do_allocate(std::size_t n, std::size_t align) override {
+            void* p = target->allocate(n, align);
+            ++counts.allocations;
+            counts.bytes += n;
+            counts.in_use += n;
+            counts.peak_bytes = std::max(counts.peak_bytes, counts.in_use);
+            return p;
+        }
+        void do_deallocate(void* p, std::size_t n, std::size_t align) override {
+            counts.in_use -= n;
+            target->deallocate(p, n, align);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+            return this == &rhs;
+        }
+
+    public:
+        // starts a run, everything allocated through this must have been given back by now (the containers cleared)
+        // the last run's arena is released, the new run allocates from upstream if given and from a fresh arena if not
+        void begin(std::pmr::memory_resource* upstream){
+            arena.release();
+            target = upstream ? upstream : &arena;
+            counts = MemoryStats();
+        }
+        const MemoryStats& stats() const {return counts;}
+};
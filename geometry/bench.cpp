@@ -0,0 +1,360 @@
+// benchmarks of the four demo algorithms and the nearest-site index on generated inputs (see workloads.hpp), for tracking regressions
+// every (algorithm, workload, n) case runs in a forked child: its peak RSS is its own (input included) and a crash or a
+// timeout only loses that case (bigger n of the same algorithm and workload are skipped after one)
+// results are one row per case, CSV on stdout unless --csv/--json say where to write them
+// run without arguments for the defaults (every algorithm and workload, n = 1e3 .. 1e6), --help for the options
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <csignal>
+#include <memory_resource>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "workloads.hpp"
+#include "hull.hpp"
+#include "segments.hpp"
+#include "fortune.hpp"
+#include "chains.hpp"
+#include "incremental.hpp"
+#include "nearest.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Case{
+    std::string algorithm;
+    std::string workload;
+    std::size_t n;
+};
+
+// what a child reports back through its pipe
+struct Timing{
+    double best_ms;
+    double median_ms;
+    uint64_t output;    // size of the result: hull points, intersections, voronoi edges, chains, distinct nearest sites
+};
+
+struct Result{
+    Case c;
+    std::string status;     // ok, crashed, timeout or invalid (finished but the output can't be right)
+    Timing t;
+    long peak_rss_kb;
+};
+
+struct Options{
+    std::vector< std::string > algorithms{"hull", "intersections", "voronoi", "chains", "nearest", "kdtree"};
+    std::vector< std::string > workloads;   // empty means every workload that fits the algorithm
+    std::size_t min_n = 1000, max_n = 1000000;
+    uint64_t seed = 1;
+    int reps = 3;
+    int timeout = 60;   // seconds per case
+    std::string memory = "arena";   // what the sweeps' node containers allocate from: arena, pool or heap (see arena.hpp)
+    std::string segments = "auto";  // how intersections are found: auto (find_intersections picks), sweep or pairs
+    std::string csv, json;
+};
+
+std::vector< std::string > split(const char* s){
+    std::vector< std::string > out;
+    std::stringstream ss(s);
+    std::string item;
+    while(std::getline(ss, item, ',')){if(!item.empty()){out.push_back(item);}}
+    return out;
+}
+
+// times reps runs of f (best and median), input preparation that isn't part of the algorithm goes in prepare
+template< typename P, typename F >
+Timing time_runs(int reps, P prepare, F f){
+    std::vector< double > ms;
+    uint64_t output = 0;
+    for(int r=0; r<reps; ++r){
+        prepare();
+        auto t0 = Clock::now();
+        output = f();
+        ms.push_back(std::chrono::duration<double, std::milli>(Clock::now()-t0).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    return Timing{ms.front(), ms[ms.size()/2], output};
+}
+
+// the baseline for nearest.hpp: a 2d tree over the points, split at the median of the wider side, and the usual search that
+// goes into the near child first and into the far one only if the splitting line is closer than the best so far
+class KdTree{
+        const std::vector< double >& xy;
+        std::vector< int > index;       // the tree in place: the median of index[lo..hi) is the node, halves are the children
+        std::vector< char > axis;       // per position of index, the split axis of the node there
+
+        void build(int lo, int hi){
+            if(hi - lo <= 1){if(hi > lo){axis[lo] = 0;} return;}
+            double x0 = xy[2*index[lo]], x1 = x0, y0 = xy[2*index[lo]+1], y1 = y0;
+            for(int k=lo+1; k<hi; ++k){
+                x0 = std::min(x0, xy[2*index[k]]); x1 = std::max(x1, xy[2*index[k]]);
+                y0 = std::min(y0, xy[2*index[k]+1]); y1 = std::max(y1, xy[2*index[k]+1]);
+            }
+            int a = (x1-x0 >= y1-y0) ? 0 : 1;
+            int mid = (lo+hi)/2;
+            std::nth_element(index.begin()+lo, index.begin()+mid, index.begin()+hi, [&](int i, int j){return xy[2*i+a] < xy[2*j+a];});
+            axis[mid] = a;
+            build(lo, mid);
+            build(mid+1, hi);
+        }
+
+        void search(int lo, int hi, double x, double y, int& best, double& best_d) const {
+            if(hi <= lo){return;}
+            int mid = (lo+hi)/2;
+            int i = index[mid];
+            double dx = xy[2*i]-x, dy = xy[2*i+1]-y;
+            double d = dx*dx + dy*dy;
+            if(d < best_d){best_d = d; best = i;}
+            double off = axis[mid] == 0 ? x - xy[2*i] : y - xy[2*i+1];
+            if(off < 0){
+                search(lo, mid, x, y, best, best_d);
+                if(off*off < best_d){search(mid+1, hi, x, y, best, best_d);}
+            }else{
+                search(mid+1, hi, x, y, best, best_d);
+                if(off*off < best_d){search(lo, mid, x, y, best, best_d);}
+            }
+        }
+
+    public:
+        KdTree(const std::vector< double >& xy) : xy(xy), index(xy.size()/2), axis(xy.size()/2){
+            for(std::size_t i=0; i<index.size(); ++i){index[i] = i;}
+            build(0, index.size());
+        }
+        // index of the point closest to (x,y)
+        int query(double x, double y) const {
+            int best = -1;
+            double best_d = std::numeric_limits< double >::infinity();
+            search(0, index.size(), x, y, best, best_d);
+            return best;
+        }
+};
+
+// generates the input and runs the algorithm, in the child
+Timing run_case(const Case& c, const Options& o){
+    std::pmr::unsynchronized_pool_resource pool;
+    std::pmr::memory_resource* mem = nullptr;   // the sweeps' own arena
+    if(o.memory == "pool"){mem = &pool;}
+    if(o.memory == "heap"){mem = std::pmr::new_delete_resource();}
+    Workload gen(o.seed);
+    std::vector< double > xy;
+    if(c.algorithm == "intersections"){
+        gen.segments(c.workload.c_str(), c.n, xy);
+        segments::lines.clear();
+        segments::lines.reserve(c.n);
+        for(std::size_t i=0; i<c.n; ++i){segments::lines.push_back(segments::Line(xy[4*i], xy[4*i+1], xy[4*i+2], xy[4*i+3]));}
+        std::vector< double >().swap(xy);
+        return time_runs(o.reps, [](){}, [&](){
+            if(o.segments == "sweep"){segments::sweep_intersections(mem);}
+            else if(o.segments == "pairs"){segments::pair_intersections();}
+            else{segments::find_intersections(mem);}
+            return (uint64_t)segments::intersections.size();
+        });
+    }
+    gen.points(c.workload.c_str(), c.n, xy);
+    if(c.algorithm == "hull"){
+        std::vector< convex::Point > points(c.n);
+        for(std::size_t i=0; i<c.n; ++i){points[i] = convex::Point{(float)xy[2*i], (float)xy[2*i+1]};}
+        std::vector< double >().swap(xy);
+        return time_runs(o.reps, [](){}, [&](){
+            return (uint64_t)convex::convex_hull(points).size();
+        });
+    }
+    if(c.algorithm == "voronoi"){
+        return time_runs(o.reps, [](){}, [&](){
+            fortune::voronoi(xy, mem);
+            return (uint64_t)fortune::D.size();
+        });
+    }
+    if(c.algorithm == "nearest" || c.algorithm == "kdtree"){
+        // n uniform queries over the same square, only the queries are timed (the index is built once, outside)
+        // both count the distinct sites their answers hit, as handles of the triangulation, so the two can be compared
+        std::vector< double > q;
+        Workload(o.seed+1, gen.size).points("uniform", c.n, q);
+        std::vector< std::pair<double,double> > queries(c.n);
+        for(std::size_t i=0; i<c.n; ++i){queries[i] = {q[2*i], q[2*i+1]};}
+        Triangulation tr(0, 0, gen.size, gen.size);
+        std::vector< int > handles;
+        tr.insert_all(xy, handles);
+        auto distinct = [&](std::vector< int >& answers){
+            std::sort(answers.begin(), answers.end());
+            return (uint64_t)(std::unique(answers.begin(), answers.end()) - answers.begin());
+        };
+        if(c.algorithm == "nearest"){
+            NearestSite index(tr);
+            return time_runs(o.reps, [](){}, [&](){
+                auto answers = index.query_batch(queries);
+                return distinct(answers);
+            });
+        }
+        KdTree tree(xy);
+        return time_runs(o.reps, [](){}, [&](){
+            // split over the same threads as query_batch, in the order the queries come
+            std::vector< int > answers(c.n);
+            int threads = std::max(1, (int)std::min< std::size_t >(std::max(1u, std::thread::hardware_concurrency()), std::max< std::size_t >(1, c.n/1024)));
+            std::vector< std::thread > pool;
+            for(int t=0; t<threads; ++t){
+                pool.emplace_back([&, t](){
+                    for(std::size_t k=c.n*t/threads; k<c.n*(t+1)/threads; ++k){answers[k] = handles[tree.query(queries[k].first, queries[k].second)];}
+                });
+            }
+            for(auto& th : pool){th.join();}
+            return distinct(answers);
+        });
+    }
+    // chains: the whole pipeline, sort included
+    std::vector< ChainPoint > input(c.n), points;
+    for(std::size_t i=0; i<c.n; ++i){input[i] = ChainPoint{(float)xy[2*i], (float)xy[2*i+1]};}
+    std::vector< double >().swap(xy);
+    ChainDecomposition chains;
+    return time_runs(o.reps, [&](){points = input;}, [&](){
+        decompose(points, chains);
+        return (uint64_t)chains.chains();
+    });
+}
+
+// whether the output size is possible at all (a voronoi diagram with more than 3n-6 edges has bogus ones)
+bool valid(const Case& c, const Timing& t){
+    if(c.algorithm == "voronoi"){return fortune::possible_edge_count(c.n, t.output);}
+    return true;
+}
+
+// forks, runs the case in the child and collects its timing and peak RSS
+Result run_isolated(const Case& c, const Options& o){
+    Result res{c, "crashed", Timing{0, 0, 0}, 0};
+    int fd[2];
+    if(pipe(fd) != 0){return res;}
+    pid_t pid = fork();
+    if(pid == 0){
+        close(fd[0]);
+        alarm(o.timeout);
+        Timing t = run_case(c, o);
+        ssize_t w = write(fd[1], &t, sizeof(t));
+        _exit(w == sizeof(t) ? 0 : 1);
+    }
+    close(fd[1]);
+    if(pid < 0){close(fd[0]); return res;}
+    Timing t;
+    bool got = read(fd[0], &t, sizeof(t)) == sizeof(t);
+    close(fd[0]);
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    res.peak_rss_kb = usage.ru_maxrss;  // kilobytes on linux
+    if(WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM){res.status = "timeout";}
+    else if(got && WIFEXITED(status) && WEXITSTATUS(status) == 0){res.status = valid(c, t) ? "ok" : "invalid"; res.t = t;}
+    return res;
+}
+
+double throughput(const Result& r){
+    return r.status == "ok" && r.t.best_ms > 0 ? r.c.n/(r.t.best_ms/1000) : 0;
+}
+
+void write_csv(std::ostream& out, const std::vector< Result >& results, const Options& o){
+    out << "algorithm,workload,n,seed,reps,memory,segments,status,best_ms,median_ms,throughput_per_s,output,peak_rss_kb\n";
+    for(auto& r : results){
+        out << r.c.algorithm << ',' << r.c.workload << ',' << r.c.n << ',' << o.seed << ',' << o.reps << ',' << o.memory << ',' << o.segments << ',' << r.status << ','
+            << r.t.best_ms << ',' << r.t.median_ms << ',' << throughput(r) << ',' << r.t.output << ',' << r.peak_rss_kb << '\n';
+    }
+}
+
+void write_json(std::ostream& out, const std::vector< Result >& results, const Options& o){
+    out << "{\n  \"seed\": " << o.seed << ",\n  \"reps\": " << o.reps << ",\n  \"memory\": \"" << o.memory << "\""
+        << ",\n  \"segments\": \"" << o.segments << "\""
+        << ",\n  \"threads\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [";
+    for(std::size_t i=0; i<results.size(); ++i){
+        auto& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"algorithm\": \"" << r.c.algorithm << "\", \"workload\": \"" << r.c.workload
+            << "\", \"n\": " << r.c.n << ", \"status\": \"" << r.status << "\", \"best_ms\": " << r.t.best_ms
+            << ", \"median_ms\": " << r.t.median_ms << ", \"throughput_per_s\": " << throughput(r)
+            << ", \"output\": " << r.t.output << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int usage(){
+    std::cerr <<
+        "usage: bench [options]\n"
+        "  --algorithms a,b,...   hull, intersections, voronoi, chains, nearest (nearest-site queries, nearest.hpp)\n"
+        "                         and kdtree (the same queries on a k-d tree, as a baseline) (default: all)\n"
+        "  --workloads a,b,...    uniform, gaussian, circle, collinear, grid (points)\n"
+        "                         long, short, parallel (segments, for intersections)\n"
+        "                         (default: every one that fits the algorithm)\n"
+        "  --min n, --max n       sizes go up by factors of 10 from min to max (default 1000 .. 1000000)\n"
+        "  --seed s               generator seed (default 1)\n"
+        "  --reps r               runs per case, best and median are reported (default 3)\n"
+        "  --timeout s            seconds per case before it's given up (default 60)\n"
+        "  --memory m             what the intersection and voronoi sweeps allocate their nodes from:\n"
+        "                         arena (one per run, the default), pool or heap\n"
+        "  --segments s           how intersections are found: auto (all pairs below\n"
+        "                         segments::pairs_below, the sweep above, the default), sweep or pairs\n"
+        "  --csv path, --json path  where to write the results (default: CSV to stdout)\n";
+    return 2;
+}
+
+int main(int argc, char** argv){
+    Options o;
+    for(int i=1; i<argc; ++i){
+        auto arg = [&](const char* name){return strcmp(argv[i], name) == 0 && i+1 < argc;};
+        if(arg("--algorithms")){o.algorithms = split(argv[++i]);}
+        else if(arg("--workloads")){o.workloads = split(argv[++i]);}
+        else if(arg("--min")){o.min_n = atof(argv[++i]);}
+        else if(arg("--max")){o.max_n = atof(argv[++i]);}
+        else if(arg("--seed")){o.seed = strtoull(argv[++i], nullptr, 10);}
+        else if(arg("--reps")){o.reps = std::max(1, atoi(argv[++i]));}
+        else if(arg("--timeout")){o.timeout = std::max(1, atoi(argv[++i]));}
+        else if(arg("--memory")){o.memory = argv[++i];}
+        else if(arg("--segments")){o.segments = argv[++i];}
+        else if(arg("--csv")){o.csv = argv[++i];}
+        else if(arg("--json")){o.json = argv[++i];}
+        else{return usage();}
+    }
+
+    if(o.memory != "arena" && o.memory != "pool" && o.memory != "heap"){return usage();}
+    if(o.segments != "auto" && o.segments != "sweep" && o.segments != "pairs"){return usage();}
+
+    std::vector< Result > results;
+    for(auto& a : o.algorithms){
+        if(a != "hull" && a != "intersections" && a != "voronoi" && a != "chains" && a != "nearest" && a != "kdtree"){
+            std::cerr << "no algorithm " << a << std::endl;
+            return usage();
+        }
+        std::vector< std::string > kinds = o.workloads;
+        if(kinds.empty()){
+            if(a == "intersections"){kinds = {"long", "short", "parallel"};}
+            else{kinds = {"uniform", "gaussian", "circle", "collinear", "grid"};}
+        }
+        for(auto& k : kinds){
+            bool fits = (a == "intersections") ? Workload::is_segments(k.c_str()) : Workload::is_points(k.c_str());
+            if(!fits){continue;}
+            for(std::size_t n = o.min_n; n <= o.max_n; n *= 10){
+                Result r = run_isolated(Case{a, k, n}, o);
+                std::cerr << a << ' ' << k << ' ' << n << ": " << r.status;
+                if(r.status == "ok"){std::cerr << ", " << r.t.best_ms << " ms, " << r.peak_rss_kb/1024 << " MB";}
+                std::cerr << std::endl;
+                results.push_back(r);
+                if(r.status != "ok"){break;}    // bigger ones won't do any better
+            }
+        }
+    }
+
+    if(!o.csv.empty()){
+        std::ofstream out(o.csv);
+        write_csv(out, results, o);
+    }
+    if(!o.json.empty()){
+        std::ofstream out(o.json);
+        write_json(out, results, o);
+    }
+    if(o.csv.empty() && o.json.empty()){write_csv(std::cout, results, o);}
+    return 0;
+}
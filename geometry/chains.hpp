@@ -0,0 +1,199 @@
+// minimum decomposition into monotone chains, patience sorting style
+// points are fed in the order of the points set (x ascending, for equal x the lower one on screen first), a chain is a run
+// of points going right and strictly up on screen (y decreasing, screen y grows downwards)
+// the tails of all chains are kept in one array sorted by y, a new point goes onto the chain whose tail is the closest one
+// below it (binary search), that tail only moves up to the new point's y and stays in order, so the array is updated in place
+// chains themselves are linked lists through one arena indexed by point, nothing is ever copied
+// O(log(#chains)) per point, O(n) memory in total
+// the same sweep also proves the number of chains is minimal (Dilworth): every point remembers the tail to the left of the
+// slot it went into, following these from the rightmost tail gives a sequence of pairwise incomparable points (y never
+// decreasing along it) with one point per chain, and no decomposition can have fewer chains than that
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+#include "presort.hpp"
+#include "trace.hpp"
+
+class ChainDecomposition{
+        std::vector< float > tail_y;        // y of the tail of every chain, ascending
+        std::vector< int > tail_chain;      // chain whose tail is tail_y[k]
+    public:
+        std::vector< float > xs, ys;        // points in the order they were added
+        std::vector< int > next;            // per point, the next point on its chain (-1 at the end)
+        std::vector< int > chain_of;        // per point, its chain
+        std::vector< int > head, last;      // per chain, its first and last point
+        std::vector< int > pred;            // per point, the tail left of its slot when it was added (-1 if none)
+
+        void clear(){
+            tail_y.clear(); tail_chain.clear();
+            xs.clear(); ys.clear(); next.clear(); chain_of.clear(); pred.clear();
+            head.clear(); last.clear();
+        }
+        void reserve(int n){
+            xs.reserve(n); ys.reserve(n); next.reserve(n); chain_of.reserve(n); pred.reserve(n);
+        }
+
+        int chains() const {return head.size();}
+        int size() const {return xs.size();}
+
+        // adds the next point in order, returns its chain
+        int add(float x, float y){
+            int p = xs.size();
+            xs.push_back(x);
+            ys.push_back(y);
+            next.push_back(-1);
+            int k = std::upper_bound(tail_y.begin(), tail_y.end(), y) - tail_y.begin();  // the closest tail strictly below y
+            pred.push_back(k > 0 ? last[tail_chain[k-1]] : -1);
+            int c;
+            if(k == (int)tail_y.size()){
+                c = head.size();
+                head.push_back(p);
+                last.push_back(p);
+                tail_y.push_back(y);
+                tail_chain.push_back(c);
+            }else{
+                c = tail_chain[k];
+                next[last[c]] = p;
+                last[c] = p;
+                tail_y[k] = y;
+            }
+            chain_of.push_back(c);
+            return c;
+        }
+
+        // a largest antichain, as many points as there are chains, in the order they were added
+        std::vector< int > antichain() const {
+            std::vector< int > out;
+            if(tail_y.empty()){return out;}
+            for(int p = last[tail_chain.back()]; p >= 0; p = pred[p]){out.push_back(p);}
+            std::reverse(out.begin(), out.end());
+            return out;
+        }
+};
+
+struct ChainPoint{
+    float x;
+    float y;
+    bool operator< (const ChainPoint& rhs) const {  // the order the sweep takes points in
+        return x < rhs.x || (x == rhs.x && y > rhs.y);
+    }
+};
+
+// sorts points into sweep order on up to threads threads (0 means one per core), by the radix sort in presort.hpp: every
+// point packs into one 64 bit key and back (-0 comes back as 0)
+inline void parallel_sort(std::vector< ChainPoint >& points, int threads = 0){
+    std::vector< uint64_t > keys(points.size());
+    for(std::size_t i=0; i<points.size(); ++i){keys[i] = presort::point_key(points[i].x, points[i].y, presort::PointOrder::by_x);}
+    presort::radix_sort(keys, [](uint64_t k){return k;}, threads);
+    for(std::size_t i=0; i<points.size(); ++i){
+        points[i] = ChainPoint{presort::float_from_bits(keys[i] >> 32), presort::float_from_bits(~(uint32_t)keys[i])};
+    }
+}
+
+// the sweep over points[order[0]], points[order[1]], ... which have to be in sweep order, as
+// presort::sort_points(..., PointOrder::by_x, ...) gives them
+inline void decompose(const std::vector< ChainPoint >& points, const std::vector< uint32_t >& order, ChainDecomposition& out){
+    TRACE_SCOPE("chains/sweep");
+    out.clear();
+    out.reserve(order.size());
+    for(uint32_t i : order){out.add(points[i].x, points[i].y);}
+    TRACE_ADD("chains/points", order.size());
+    TRACE_MAX("chains/max_chains", out.chains());
+}
+
+// the whole pipeline for big inputs in any order: parallel sort, then the (sequential, O(n log(#chains))) sweep
+inline void decompose(std::vector< ChainPoint >& points, ChainDecomposition& out, int threads = 0){
+    {
+        TRACE_SCOPE("chains/sort");
+        parallel_sort(points, threads);
+    }
+    TRACE_SCOPE("chains/sweep");
+    out.clear();
+    out.reserve(points.size());
+    for(auto& p : points){out.add(p.x, p.y);}
+    TRACE_ADD("chains/points", points.size());
+    TRACE_MAX("chains/max_chains", out.chains());
+}
+
+// maxima layers (staircase peeling): layer 0 are the points no other point is right of and above (a pareto front),
+// layer k those only dominated by points of layers < k
+// the dual of the chain sweep: walking the sweep order backwards (right to left), every layer keeps its highest point so
+// far, a point dominated by layer k (some earlier point is above it) goes one layer further, and the first layer whose
+// highest point is below it is its layer. like the chain tails these are sorted and updated in place, a binary search each
+// points must be in sweep order (as ChainPoint sorts), layer[i] is the layer of points[i], returns the number of layers
+// (exact duplicates dominate each other here and end up on successive layers)
+inline int maxima_layers(const std::vector< ChainPoint >& points, std::vector< int >& layer){
+    std::vector< float > top_y;     // screen y of the highest point of every layer so far, ascending
+    layer.resize(points.size());
+    for(std::size_t i=points.size(); i-- > 0;){
+        float y = points[i].y;
+        int k = std::upper_bound(top_y.begin(), top_y.end(), y) - top_y.begin();
+        if(k == (int)top_y.size()){top_y.push_back(y);}
+        else{top_y[k] = y;}
+        layer[i] = k;
+    }
+    return top_y.size();
+}
+
+// online version for inputs that don't fit in memory: points have to arrive already in sweep order, only the tails are
+// kept (O(#chains) memory) and every point is appended to a file as a (chain, x, y) record the moment it joins a chain
+// (a chain's points appear in the file in chain order, so filtering the file by chain id reads the chain back)
+struct ChainRecord{
+    uint32_t chain;
+    float x;
+    float y;
+};
+
+class ChainStream{
+        std::vector< float > tail_y;
+        std::vector< uint32_t > tail_chain;
+        FILE* out = nullptr;
+        float last_x = 0, last_y = 0;
+        uint64_t count = 0;
+    public:
+        bool ok = false;        // false once the file couldn't be written or a point came out of order
+
+        ChainStream(const char* path){
+            out = fopen(path, "wb");
+            ok = (out != nullptr);
+            if(ok){setvbuf(out, nullptr, _IOFBF, 1<<20);}
+        }
+        ChainStream(const ChainStream&) = delete;
+        ChainStream& operator=(const ChainStream&) = delete;
+        ~ChainStream(){close();}
+
+        uint32_t chains() const {return tail_chain.size();}
+        uint64_t size() const {return count;}
+
+        // adds the next point, returns its chain (or -1, and ok turns false, if it is out of order or can't be written)
+        long long add(float x, float y){
+            if(!ok){return -1;}
+            if(count > 0 && ChainPoint{x, y} < ChainPoint{last_x, last_y}){ok = false; return -1;}
+            last_x = x; last_y = y;
+            ++count;
+            std::size_t k = std::upper_bound(tail_y.begin(), tail_y.end(), y) - tail_y.begin();
+            if(k == tail_y.size()){
+                tail_y.push_back(y);
+                tail_chain.push_back(tail_chain.size());
+            }else{
+                tail_y[k] = y;
+            }
+            ChainRecord r{tail_chain[k], x, y};
+            if(fwrite(&r, sizeof(r), 1, out) != 1){ok = false; return -1;}
+            return r.chain;
+        }
+
+        // flushes and closes the file, false if anything went wrong on the way
+        bool close(){
+            if(out){
+                if(fclose(out) != 0){ok = false;}
+                out = nullptr;
+            }
+            return ok;
+        }
+};
@@ -0,0 +1,154 @@
+// checks that engines which get to the same answer two ways agree on it
+// intersections: find_intersections gives the same answer on both sides of segments::pairs_below, where it switches from the
+// all-pairs kernel to the sweep: each input runs through both engines and the two results have to be the same points
+// (within the tolerance) with the same segment ids
+// the inputs are short segments with horizontal ones mixed in (some on shared rows, so they overlap each other), vertical
+// ones on shared columns and collinear overlapping copies, just below and just above the switch
+// (find_intersections takes all pairs at the first size and the sweep at the second)
+// and a sweep stopped half way followed by an all-pairs run and another sweep
+// emst: IncrementalEmst, updated after every single insertion into a Triangulation, against emst() of the same sites from
+// scratch, on uniform, gaussian (clamped, so some sites pile up on the border) and grid points (cocircular everywhere)
+//  make run-check    prints one line per case, exits with 1 if any of them differ
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "workloads.hpp"
+#include "segments.hpp"
+#include "incremental.hpp"
+#include "graphs.hpp"
+
+// n segments (x0 y0 x1 y1 ...) from the short workload, every fifth one horizontal, every fifth one after that on a row
+// shared with others, every fifth after that a copy of the one before shifted half its length along itself, and every fifth
+// after that vertical on a shared column
+std::vector< double > mixed_segments(std::size_t n, uint64_t seed){
+    std::vector< double > s;
+    Workload(seed).segments("short", n, s);
+    for(std::size_t i=0; i<n; ++i){
+        double* p = &s[4*i];
+        switch(i%5){
+            case 0: p[3] = p[1]; break;
+            case 1: p[1] = p[3] = std::floor(p[1]/50)*50; break;
+            case 2:{
+                if(i == 0){break;}
+                double* q = p-4;
+                double dx = q[2]-q[0], dy = q[3]-q[1];
+                p[0] = q[0] + dx/2; p[1] = q[1] + dy/2;
+                p[2] = p[0] + dx; p[3] = p[1] + dy;
+                break;
+            }
+            case 3: p[0] = p[2] = std::floor(p[0]/50)*50; break;
+            default: break;
+        }
+    }
+    return s;
+}
+
+void load(const std::vector< double >& s){
+    segments::lines.clear();
+    for(std::size_t i=0; i+3<s.size(); i+=4){segments::lines.push_back(segments::Line(s[i], s[i+1], s[i+2], s[i+3]));}
+}
+
+std::vector< segments::Intersection > run(const std::vector< double >& s, bool sweep){
+    load(s);
+    if(sweep){segments::sweep_intersections();}
+    else{segments::pair_intersections();}
+    return segments::intersections;
+}
+
+// whether a and b are the same intersections, in any order
+bool same(std::vector< segments::Intersection > a, std::vector< segments::Intersection > b){
+    if(a.size() != b.size()){return false;}
+    auto by_ids = [](const segments::Intersection& p, const segments::Intersection& q){
+        if(p.lines != q.lines){return p.lines < q.lines;}
+        return p.at < q.at;
+    };
+    std::sort(a.begin(), a.end(), by_ids);
+    std::sort(b.begin(), b.end(), by_ids);
+    for(std::size_t i=0; i<a.size(); ++i){
+        if(a[i].lines != b[i].lines || a[i].at < b[i].at || b[i].at < a[i].at){return false;}
+    }
+    return true;
+}
+
+// a sweep stopped through progress leaves Q and T full of nodes from its arena: an all-pairs run after it (which starts
+// the arena over too) and a sweep after that have to get rid of them first, instead of touching them once it's released
+bool after_stopped_sweep(){
+    auto big = mixed_segments(segments::pairs_below+1000, 4), small = mixed_segments(10, 5);
+    {
+        progress::Scope stop([](double){return false;});
+        run(big, true);
+    }
+    if(segments::Q.empty()){return false;}     // it didn't stop, nothing was tested
+    load(small);
+    segments::find_intersections();
+    load(big);
+    segments::find_intersections();
+    return same(segments::intersections, run(big, false));
+}
+
+// whether the tree's edges span all the sites of tr, and their total length
+bool spanning(const Triangulation& tr, const std::vector< std::pair<int,int> >& edges, double& length){
+    UnionFind uf(tr.size());
+    length = 0;
+    for(auto& e : edges){
+        if(!uf.unite(e.first, e.second)){return false;}
+        length += std::hypot(tr.site(e.first).x-tr.site(e.second).x, tr.site(e.first).y-tr.site(e.second).y);
+    }
+    return (int)edges.size() == std::max(tr.size()-1, 0);
+}
+
+// n points of the given kind in one at a time (in random order), the incremental tree against emst() every 250 sites and at the end
+bool same_emst(const char* kind, std::size_t n, uint64_t seed){
+    std::vector< double > xy;
+    Workload(seed).points(kind, n, xy);
+    std::vector< std::size_t > order(n);
+    for(std::size_t i=0; i<n; ++i){order[i] = i;}
+    std::shuffle(order.begin(), order.end(), std::mt19937(seed));     // grid points come in rows, which never replace an edge
+    Triangulation tr(0, 0, 1000, 1000);
+    IncrementalEmst tree(tr);
+    for(std::size_t i=0; i<n; ++i){
+        int before = tr.size();
+        tr.insert(xy[2*order[i]], xy[2*order[i]+1]);
+        if(tr.size() == before){continue;}
+        tree.update();
+        if(tr.size()%250 != 0 && i+1 < n){continue;}
+        std::vector< std::pair<int,int> > grown, scratch;
+        for(int k=0; k<tree.size(); ++k){grown.push_back(tree.edge(k));}
+        Graph g = emst(tr);
+        for(int v=0; v<g.size(); ++v){
+            for(int k=g.offset[v]; k<g.offset[v+1]; ++k){
+                if(g.adj[k] > v){scratch.push_back({v, g.adj[k]});}
+            }
+        }
+        double a, b;
+        if(!spanning(tr, grown, a) || !spanning(tr, scratch, b) || std::abs(a-b) > 1e-9*b){return false;}
+    }
+    return true;
+}
+
+int main(){
+    bool ok = true;
+    for(std::size_t n : {segments::pairs_below-1, segments::pairs_below+1}){
+        for(uint64_t seed : {1, 2, 3}){
+            auto s = mixed_segments(n, seed);
+            auto pairs = run(s, false), sweep = run(s, true);
+            bool agree = same(pairs, sweep);
+            std::cout << "intersections, " << n << " mixed segments, seed " << seed << ": all pairs " << pairs.size()
+                      << ", sweep " << sweep.size() << (agree ? ", same" : ", DIFFERENT") << std::endl;
+            ok = ok && agree && !pairs.empty();
+        }
+    }
+    bool survived = after_stopped_sweep();
+    std::cout << "intersections, stopped sweep then all pairs then sweep: " << (survived ? "same" : "DIFFERENT") << std::endl;
+    ok = ok && survived;
+    for(const char* kind : {"uniform", "gaussian", "grid"}){
+        bool agree = same_emst(kind, 3000, 1);
+        std::cout << "emst, 3000 " << kind << " points one at a time: " << (agree ? "same" : "DIFFERENT") << std::endl;
+        ok = ok && agree;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+// coordinate types and tolerances for the kernels, picked at compile time instead of a float here, a long double there and
+// an EPSILON macro per header
+//  Kernel< T, Tol >    the coordinate type T (float, double, int32_t, int64_t), the wider type its predicates are evaluated
+//                      in and when two values count as equal (Tol, by default Exact for integers and a small absolute
+//                      tolerance for floating point)
+//  Tolerance< e >      values closer than 10^e are equal
+//  Exact               only equal values are, only for integers: their predicates are exact as long as the coordinates
+//                      stay below 2^30 (int32_t) or 2^62 (int64_t) in absolute value, so the products fit the wide type
+// the cheapest type that's exact enough for the input is the one to use: integer grids don't need floating point at all
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace coords{
+
+constexpr double power_of_ten(int e){
+    double p = 1;
+    for(; e > 0; --e){p *= 10;}
+    for(; e < 0; ++e){p /= 10;}
+    return p;
+}
+
+struct Exact{
+    template< typename W >
+    static constexpr bool zero(W v){return v == 0;}
+};
+
+template< int e >
+struct Tolerance{
+    static constexpr double epsilon = power_of_ten(e);
+    template< typename W >
+    static constexpr bool zero(W v){return v < epsilon && v > -epsilon;}
+};
+
+// what the predicates multiply in: floats in double (a float times a float is exact in double), the rest twice as wide
+template< typename T > struct Wide;
+template<> struct Wide< float >{typedef double type;};
+template<> struct Wide< double >{typedef double type;};
+template<> struct Wide< long double >{typedef long double type;};
+template<> struct Wide< int32_t >{typedef int64_t type;};
+template<> struct Wide< int64_t >{typedef __int128 type;};
+
+template< typename T >
+using DefaultTolerance = typename std::conditional< std::is_integral< T >::value, Exact, Tolerance< -7 > >::type;
+
+template< typename T, typename Tol = DefaultTolerance< T > >
+struct Kernel{
+    typedef T coord;
+    typedef typename Wide< T >::type wide;
+    static constexpr bool exact = std::is_integral< T >::value && std::is_same< Tol, Exact >::value;
+    static_assert(std::is_floating_point< T >::value || std::is_same< Tol, Exact >::value, "integer coordinates are compared exactly");
+
+    static constexpr coord inf(){return std::numeric_limits< coord >::max();}
+    static constexpr bool zero(wide v){return Tol::zero(v);}
+    static constexpr bool close(wide a, wide b){return Tol::zero(a-b);}
+
+    // (b-a) x (c-b) and (b-a) . (c-b) in the wide type, exact for Exact kernels
+    static constexpr wide cross(coord ax, coord ay, coord bx, coord by, coord cx, coord cy){
+        return (wide(bx)-ax)*(wide(cy)-by) - (wide(by)-ay)*(wide(cx)-bx);
+    }
+    static constexpr wide dot(coord ax, coord ay, coord bx, coord by, coord cx, coord cy){
+        return (wide(bx)-ax)*(wide(cx)-bx) + (wide(by)-ay)*(wide(cy)-by);
+    }
+};
+
+}
@@ -0,0 +1,258 @@
+// protocol of geomd, the long-running geometry service (geomd.cpp), and the client side of it
+// geomd listens on a Unix-domain socket (SOCK_SEQPACKET, so every message arrives whole) on the local machine only
+// coordinates never go through the socket: the client puts its points into a shared memory buffer (a memfd, see
+// SharedBuffer) and passes the descriptor along with the request, geomd maps it and runs the algorithm on the mapping,
+// then writes the result into a fresh memfd of its own and passes that back, which the client maps in turn
+// a message is a batch of up to DAEMON_MAX_BATCH requests: DaemonBatch, then size x DaemonRequest, with one descriptor per
+// request attached (SCM_RIGHTS, the same descriptor may be attached several times). requests of a batch run in parallel
+// on geomd's worker threads, the reply is one message for the whole batch when its last request is done: DaemonBatch (same
+// id), then size x DaemonReply, with one descriptor attached for every reply whose status is DAEMON_OK, in order
+// a client may send more batches before the replies come in, they are told apart by id and may come back in any order
+//
+// a request's buffer has count points at byte offset (a multiple of 8): count x (double x, double y), native endianness
+// the buffer has to be sealed against shrinking (SharedBuffer::create does that) so geomd can't be made to read past its
+// end, unsealed buffers are refused with DAEMON_BAD_BUFFER
+// what the result buffers hold, count being DaemonReply::count:
+//  DAEMON_HULL            count x (double x, double y)          the hull, counter-clockwise on screen (first point not repeated)
+//                                                               (exact int32 kernel when all coordinates are integers below 2^30)
+//  DAEMON_INTERSECTIONS   count x (double x, double y)          intersections, points 2i and 2i+1 of the request are segment i
+//                         (count+1) x uint64                    segments through intersection k are ids[offset[k] .. offset[k+1])
+//                         x uint32                              ids
+//  DAEMON_VORONOI         count x DaemonEdge                    Fortune's sweep, as geomcli voronoi
+//  DAEMON_DELAUNAY        count x (uint32 i, j, k)              delaunay triangles (point indices), as geomcli delaunay
+//  DAEMON_CHAINS          count x ChainRecord                   chain decomposition in sweep order, as geomcli chains
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+const uint32_t DAEMON_MAGIC = 0x444d4547;   // "GEMD"
+const int DAEMON_MAX_BATCH = 64;            // well below the kernel's limit of descriptors per message (253)
+
+enum DaemonOp : uint32_t{
+    DAEMON_HULL = 1,
+    DAEMON_INTERSECTIONS = 2,
+    DAEMON_VORONOI = 3,
+    DAEMON_DELAUNAY = 4,
+    DAEMON_CHAINS = 5
+};
+
+enum DaemonStatus : int32_t{
+    DAEMON_OK = 0,
+    DAEMON_BAD_REQUEST = 1,     // unknown op, too many points
+    DAEMON_BAD_BUFFER = 2,      // missing descriptor, not sealed, too small for count points at offset
+    DAEMON_FAILED = 3           // geomd couldn't map the buffer or make the result
+};
+
+struct DaemonBatch{
+    uint32_t magic;
+    uint32_t size;          // requests (or replies) that follow
+    uint64_t id;            // chosen by the client, sent back with the replies
+};
+
+struct DaemonRequest{
+    uint32_t op;            // DaemonOp
+    uint32_t reserved;      // 0
+    uint64_t count;         // points
+    uint64_t offset;        // bytes into the buffer
+};
+
+struct DaemonReply{
+    int32_t status;         // DaemonStatus
+    uint32_t op;
+    uint64_t count;         // items of the result, see above
+    uint64_t bytes;         // size of the result buffer
+};
+
+struct DaemonEdge{
+    uint32_t i, j;          // the voronoi edge between the cells of points i and j (the delaunay edge i-j)
+    uint32_t finite;        // 0 for a ray, which then ends at a far point in its direction
+    uint32_t reserved;
+    double x1, y1, x2, y2;
+};
+
+// a memfd mapped read-write (one we made) or read-only (one we got), unmapped and closed when it goes
+class SharedBuffer{
+        void release(){
+            if(data && bytes > 0){munmap(data, bytes);}
+            if(fd >= 0){close(fd);}
+            fd = -1; data = nullptr; bytes = 0;
+        }
+    public:
+        int fd = -1;
+        char* data = nullptr;
+        std::size_t bytes = 0;
+
+        SharedBuffer(){}
+        SharedBuffer(const SharedBuffer&) = delete;
+        SharedBuffer& operator=(const SharedBuffer&) = delete;
+        SharedBuffer(SharedBuffer&& rhs){*this = std::move(rhs);}
+        SharedBuffer& operator=(SharedBuffer&& rhs){
+            if(this != &rhs){
+                release();
+                std::swap(fd, rhs.fd); std::swap(data, rhs.data); std::swap(bytes, rhs.bytes);
+            }
+            return *this;
+        }
+        ~SharedBuffer(){release();}
+
+        // a new buffer of size bytes (zeroed), writable, that can't shrink or grow any more
+        bool create(std::size_t size, const char* name = "geom"){
+            release();
+            fd = memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            if(fd < 0){return false;}
+            if(ftruncate(fd, size) != 0 || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0){
+                release();
+                return false;
+            }
+            if(size > 0){
+                void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if(p == MAP_FAILED){release(); return false;}
+                data = (char*)p;
+            }
+            bytes = size;
+            return true;
+        }
+        // maps size bytes of descriptor d read-only, the buffer owns d from now on (even if that fails)
+        bool map(int d, std::size_t size){
+            release();
+            fd = d;
+            if(size > 0){
+                void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                if(p == MAP_FAILED){release(); return false;}
+                data = (char*)p;
+            }
+            bytes = size;
+            return true;
+        }
+};
+
+// sends a message with descriptors attached, false if it didn't go out whole (flags go to sendmsg, MSG_DONTWAIT to not
+// wait for room: false with errno EAGAIN then)
+inline bool send_with_fds(int sock, const std::vector< char >& message, const std::vector< int >& fds, int flags = 0){
+    iovec iov{(void*)message.data(), message.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    std::vector< char > control(CMSG_SPACE(sizeof(int)*fds.size()));
+    if(!fds.empty()){
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        cmsghdr* c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int)*fds.size());
+        memcpy(CMSG_DATA(c), fds.data(), sizeof(int)*fds.size());
+    }
+    ssize_t sent;
+    do{sent = sendmsg(sock, &msg, MSG_NOSIGNAL | flags);}while(sent < 0 && errno == EINTR);
+    return sent == (ssize_t)message.size();
+}
+
+// receives one message and the descriptors that came with it (the caller owns them), the message's size, 0 once the peer
+// is gone and -1 on errors (descriptors of a message that didn't fit are closed, and it counts as an error)
+inline ssize_t receive_with_fds(int sock, std::vector< char >& message, std::vector< int >& fds){
+    iovec iov{message.data(), message.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    std::vector< char > control(CMSG_SPACE(sizeof(int)*DAEMON_MAX_BATCH));
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    ssize_t got;
+    do{got = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);}while(got < 0 && errno == EINTR);
+    fds.clear();
+    if(got < 0){return -1;}
+    for(cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)){
+        if(c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS){continue;}
+        std::size_t n = (c->cmsg_len - CMSG_LEN(0))/sizeof(int);
+        std::size_t at = fds.size();
+        fds.resize(at+n);
+        memcpy(fds.data()+at, CMSG_DATA(c), sizeof(int)*n);
+    }
+    if(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)){
+        for(int fd : fds){close(fd);}
+        fds.clear();
+        return -1;
+    }
+    return got;
+}
+
+inline std::size_t batch_message_size(){return sizeof(DaemonBatch) + DAEMON_MAX_BATCH*std::max(sizeof(DaemonRequest), sizeof(DaemonReply));}
+
+// one connection to geomd, one batch at a time
+class DaemonClient{
+        int sock = -1;
+        uint64_t next_id = 1;
+    public:
+        DaemonClient(const char* path){
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if(strlen(path) >= sizeof(addr.sun_path)){return;}
+            strcpy(addr.sun_path, path);
+            sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+            if(sock >= 0 && connect(sock, (sockaddr*)&addr, sizeof(addr)) != 0){
+                close(sock);
+                sock = -1;
+            }
+        }
+        DaemonClient(const DaemonClient&) = delete;
+        DaemonClient& operator=(const DaemonClient&) = delete;
+        ~DaemonClient(){if(sock >= 0){close(sock);}}
+
+        bool ok() const {return sock >= 0;}
+
+        // runs requests[i] on the buffer fds[i] (at most DAEMON_MAX_BATCH of them) and waits for all of them, replies[i] is
+        // how request i went and results[i] its result, mapped read-only, if that is DAEMON_OK
+        // false if geomd couldn't be reached or answered nonsense
+        bool call(const std::vector< DaemonRequest >& requests, const std::vector< int >& fds,
+                  std::vector< DaemonReply >& replies, std::vector< SharedBuffer >& results){
+            if(sock < 0 || requests.empty() || requests.size() > (std::size_t)DAEMON_MAX_BATCH || fds.size() != requests.size()){return false;}
+            DaemonBatch head{DAEMON_MAGIC, (uint32_t)requests.size(), next_id++};
+            std::vector< char > message(sizeof(head) + sizeof(DaemonRequest)*requests.size());
+            memcpy(message.data(), &head, sizeof(head));
+            memcpy(message.data()+sizeof(head), requests.data(), sizeof(DaemonRequest)*requests.size());
+            if(!send_with_fds(sock, message, fds)){return false;}
+
+            std::vector< int > got;
+            message.resize(batch_message_size());
+            ssize_t n = receive_with_fds(sock, message, got);
+            DaemonBatch back;
+            bool ok = n >= (ssize_t)sizeof(back);
+            if(ok){
+                memcpy(&back, message.data(), sizeof(back));
+                ok = back.magic == DAEMON_MAGIC && back.id == head.id && back.size == head.size
+                  && (std::size_t)n == sizeof(back) + sizeof(DaemonReply)*back.size;
+            }
+            if(ok){
+                replies.resize(back.size);
+                memcpy(replies.data(), message.data()+sizeof(back), sizeof(DaemonReply)*back.size);
+                std::size_t expected = 0;
+                for(auto& r : replies){expected += (r.status == DAEMON_OK);}
+                ok = (expected == got.size());
+            }
+            if(!ok){
+                for(int fd : got){close(fd);}
+                return false;
+            }
+            results.clear();
+            results.resize(replies.size());
+            std::size_t k = 0;
+            for(std::size_t i=0; i<replies.size(); ++i){
+                if(replies[i].status != DAEMON_OK){continue;}
+                if(!results[i].map(got[k++], replies[i].bytes)){replies[i].status = DAEMON_FAILED;}
+            }
+            return true;
+        }
+};
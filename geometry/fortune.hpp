@@ -0,0 +1,467 @@
+// voronoi diagram and delaunay graph, Fortune's sweep (top to bottom)
+// plain coordinates, no drawing: the voronoi_and_delaunay demo draws the result
+// coordinates are screen coordinates (y grows downwards)
+// the coordinate type is picked at compile time (see coords.hpp), define GEOM_FORTUNE_COORD before including to change it
+
+#pragma once
+
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <memory_resource>
+
+#include "arena.hpp"
+#include "coords.hpp"
+#include "presort.hpp"
+#include "progress.hpp"
+#include "hilbert.hpp"
+#include "trace.hpp"
+
+#ifndef GEOM_FORTUNE_COORD
+#define GEOM_FORTUNE_COORD double
+#endif
+
+namespace fortune{
+
+typedef coords::Kernel< GEOM_FORTUNE_COORD, coords::Tolerance< -5 > > K;
+typedef K::coord coord;
+static_assert(std::is_floating_point< coord >::value, "the sweep needs floating point coordinates");
+
+inline coord sweep_line_y = -K::inf();    // y-coordinate of the sweeping line
+inline uint64_t sweep_epoch = 1;      // bumped whenever sweep_line_y moves, breakpoints cached in an older epoch are stale
+
+class Site;
+class Event;
+class Arc;
+class Edge;
+
+/*
+    what the sweep actually works on: a compact copy of the input coordinates, renumbered along a Hilbert curve
+    (see hilbert.hpp) so that sites next to each other in the plane are next to each other in memory.
+    arcs, events and edges refer to sites by 32 bit index into this array, site_id maps an index back to the input
+*/
+inline std::vector< Site > sites;
+inline std::vector< uint32_t > site_id;
+const uint32_t NO_SITE = UINT32_MAX;   // the missing left/right neighbour of the leftmost/rightmost arc
+// Q, T and D allocate through memory (see arena.hpp), by default from an arena per run that D's edges stay in until the next
+inline SweepMemory memory;
+inline std::pmr::set< Event > Q{&memory};
+inline std::pmr::set< Arc, std::less<> > T{&memory};
+inline std::pmr::set< Edge > D{&memory};
+
+class Site{
+    public:
+        coord x;
+        coord y;
+
+        coord intersect(const Site& rhs) const {
+            TRACE_COUNT("fortune/parabola_intersect");
+            // x-coord of intersection <lhs,rhs> of parabolas given by lhs and rhs (depends on sweeping line's position)
+            // (different from <rhs,lhs> which is the other point of intersection of the same two parabolas)
+            if(K::close(y,rhs.y)){
+                if(x<rhs.x){
+                    return (x+rhs.x)/2;
+                }else{
+                    // undefined (unexpected?), should never get here
+                    return K::inf();
+                }
+            }
+
+            coord x2 = x-rhs.x;
+            coord y2 = y-rhs.y;
+            x2 *= x2; y2 *= y2;
+            coord y1_l = y-sweep_line_y;
+            coord y2_l = rhs.y-sweep_line_y;
+            
+            // why do i need to do this? because sqrt(-0.000) is -NaN. doubles are the bane of my existence. how is your day going, fellow comment reader?
+            // (clamped, not zeroed when a site is merely close to the line: an arc 1e-5 below its site is already ~0.05 wide)
+            coord root = sqrt(std::max< coord >(y1_l*y2_l*(x2+y2), 0));
+
+            return (x*y2_l - rhs.x*y1_l + root)/(rhs.y-y);
+            // turns out, the sign of (rhs.y-y) is exactly the choice of adding root vs subtracting root, so always +root (never -root)
+        }
+};
+
+class Arc{
+    public:
+        // left and right change in place when a neighbouring arc disappears, the arc keeps its position in T
+        mutable uint32_t left; // maybe NO_SITE
+        uint32_t middle;
+        mutable uint32_t right; // maybe NO_SITE
+        
+        /*
+            an iterator of Q: 'pointer' to the circle event (if exists) where this arc disappears (Q.end() if doesn't exist)
+            mutable means it can be changed for const objects (in place updating a std::set element)
+        */
+        mutable std::pmr::set< Event >::iterator circle_event;
+
+        /*
+            the breakpoints on either side of this arc only move when the sweep line does, but one T.upper_bound or insert
+            asks for the same ones several times (and check_for_circle_event once more), so they are kept for the epoch
+        */
+        mutable coord left_x, right_x;
+        mutable uint64_t left_epoch = 0, right_epoch = 0;
+
+        Arc(uint32_t a, uint32_t b, uint32_t c){
+            left = a;
+            middle = b;
+            right = c;
+            circle_event = Q.end();
+        }
+
+        // x-coords of the breakpoints <left,middle> and <middle,right>, only valid if that neighbour exists
+        // (fortune/breakpoint_hits and fortune/breakpoint_misses count how often the cached one was still good)
+        coord left_breakpoint() const {
+            if(left_epoch == sweep_epoch){TRACE_COUNT("fortune/breakpoint_hits"); return left_x;}
+            TRACE_COUNT("fortune/breakpoint_misses");
+            left_epoch = sweep_epoch;
+            return left_x = sites[left].intersect(sites[middle]);
+        }
+        coord right_breakpoint() const {
+            if(right_epoch == sweep_epoch){TRACE_COUNT("fortune/breakpoint_hits"); return right_x;}
+            TRACE_COUNT("fortune/breakpoint_misses");
+            right_epoch = sweep_epoch;
+            return right_x = sites[middle].intersect(sites[right]);
+        }
+
+        coord angle_measure() const {
+            // used to compare zero width arcs (only?)
+            // hard to explain in words without a diagram
+            // chosen carefully but isn't an important part of the algorithm (i think)
+            const Site& l = sites[left];
+            const Site& m = sites[middle];
+            const Site& r = sites[right];
+            coord angle1 = -atan2(m.y-l.y, m.x-l.x);
+            coord angle2 = -atan2(r.y-m.y, r.x-m.x);
+            return (angle1+angle2)/2;
+        }
+
+        bool operator< (const Arc& rhs) const{
+            TRACE_COUNT("fortune/arc_compare");
+            if(left == NO_SITE){return true;}
+            if(right == NO_SITE){return false;}
+            if(rhs.left == NO_SITE){return false;}
+            if(rhs.right == NO_SITE){return true;}
+
+            coord r1 = right_breakpoint();
+            coord r2 = rhs.right_breakpoint();
+            if(!K::close(r1,r2)){
+                return r1 < r2;
+            }
+            coord l1 = left_breakpoint();
+            if(!K::close(l1,r1)){return true;}
+            coord l2 = rhs.left_breakpoint();
+            if(!K::close(l2,r2)){return false;}
+
+            // co-incident and zero width arcs
+            // if one of them is a degenerate parabola from a new site it comes before the other zero width arcs of non-degenerate parabolas
+            if(K::close(sites[middle].y, sweep_line_y)){
+                return true;
+            }
+            if(K::close(sites[rhs.middle].y, sweep_line_y)){
+                return false;
+            }
+            // comparing actual zero width arcs (coinciding circle events cause this)
+            return angle_measure()<rhs.angle_measure();
+        }
+        bool operator< (const coord& x) const{
+            if(right == NO_SITE){
+                return false;
+            }
+            coord tmp = right_breakpoint();
+            if(K::close(tmp, x)){
+                return false;
+            }
+            return tmp < x;
+        }
+        friend bool operator< (const coord& x, const Arc& rhs){
+            if(rhs.right == NO_SITE){
+                return true;
+            }
+            coord tmp = rhs.right_breakpoint();
+            if(K::close(tmp, x)){
+                return true;   
+            }
+            return x < tmp;
+        }
+};
+
+class Event{
+    public:
+        coord x;
+        coord y;
+        bool isSite;
+
+        // for site events only
+        uint32_t site = NO_SITE;
+        
+        // for circle_events only 
+        coord y_c; // (y-cord of center = this->y + radius )
+        std::pmr::set< Arc, std::less<> >::iterator arc; // an iterator of T: 'pointer' to the arc which disappears in this circle event
+
+        Event(coord x, coord y, uint32_t p){
+            this->x = x;
+            this->y = y;
+            site = p;
+            isSite = true;
+        }
+        Event(coord x, coord y, coord y_c, std::pmr::set< Arc, std::less<> >::iterator a){
+            this->x = x;
+            this->y = y;
+            this->y_c = y_c;
+            arc = a;
+            isSite = false;
+        }
+        bool operator< (const Event& rhs) const{
+            if(!K::close(y, rhs.y)){
+                return y > rhs.y;
+            }
+            if(!K::close(x, rhs.x)){
+                return x < rhs.x;
+            }
+            if(isSite && rhs.isSite){return false;} // two site events are duplicates
+            
+            if(isSite && !rhs.isSite){return false;} // circle before site
+            if(!isSite && rhs.isSite){return true;} // circle before site
+            
+            return *arc < *(rhs.arc) ; // two circle events, order ambiguity deferred to their arcs
+        }
+};
+
+class Edge{
+    public:
+        uint32_t p1;    // the two sites (indices into sites) whose cells this edge separates,
+        uint32_t p2;    // equivalently the ends of the dual delaunay edge
+        mutable coord x1, y1;  // voronoi edge, (x2,y2) is only a far point in its direction until finite
+        mutable coord x2, y2;
+        mutable bool finite = false;
+
+        Edge(uint32_t p1, uint32_t p2, coord x, coord y, bool reverse = true){
+            this->p1 = p1;
+            this->p2 = p2;
+            const Site& a = sites[p1];
+            const Site& b = sites[p2];
+            x1 = x; y1 = y;
+            coord t = reverse ? -100 : 100;
+            x2 = x + t*(b.y-a.y);
+            y2 = y - t*(b.x-a.x);
+        }
+        void second_vertex(coord x, coord y) const {
+            x2 = x; y2 = y;
+            finite = true;
+        }
+        bool operator<(const Edge& rhs) const {
+            // .. idk what i'm doing,
+            /*
+                it would make so much more sense to use std::unordered_set 
+                with overloaded operator== instead of this hot garbage 
+                but then i need to define std::hash<Edge> 
+                for an unordered pair of pointers and I just couldn't be bothered
+                ... maybe some other day
+            */
+            auto& _p1 = std::min(p1,p2);
+            auto& _p2 = std::max(p1,p2);
+            auto& _rp1 = std::min(rhs.p1,rhs.p2);
+            auto& _rp2 = std::max(rhs.p1,rhs.p2);
+            return (_p1<_rp1) || (_p1==_rp1 && _p2<_rp2);
+        }
+};
+
+inline void check_for_circle_event(std::pmr::set< Arc, std::less<> >::iterator self) {
+    // self is the iterator in T for this object, to pass onto the circle_event we may create (whose iterator we save in this object)
+    // storing pointers to each other would be easier but need it to point to the position in std::set
+    if(self->left == NO_SITE || self->right == NO_SITE){
+        self->circle_event = Q.end(); 
+        return;
+    }
+    if(self->left == self->right){
+        self->circle_event = Q.end(); 
+        return;
+    }
+    const Site* left = &sites[self->left];
+    const Site* middle = &sites[self->middle];
+    const Site* right = &sites[self->right];
+
+    coord x32 = right->x - middle->x, y32 = right->y - middle->y;
+    coord x21 = middle->x - left->x, y21 = middle->y - left->y;
+    coord cross = x32*y21 - y32*x21;
+    coord l2 = x21*x21 + y21*y21, r2 = x32*x32 + y32*y32;
+
+    // the breakpoints on either side only meet (below the sweep line) if left, middle, right turn this way round. decided from
+    // the sites alone: the breakpoints' positions can be off by the tolerance after coinciding events and must not veto it.
+    // collinear is up to the rounding of cross, which grows with the coordinates and the lengths (not an absolute tolerance:
+    // neighbours on a dense circle turn by less than that)
+    coord scale = std::max({std::abs(left->x), std::abs(left->y), std::abs(middle->x), std::abs(middle->y), std::abs(right->x), std::abs(right->y)});
+    if(cross <= 8*std::numeric_limits< coord >::epsilon()*scale*(sqrt(l2) + sqrt(r2))){
+        self->circle_event = Q.end();
+        return;
+    }
+
+    // center of the circle through the three sites, relative to middle
+    coord dx = (y32*l2 + y21*r2)/(2*cross);
+    coord dy = -(x21*r2 + x32*l2)/(2*cross);
+    coord x = middle->x + dx;
+    coord y_c = middle->y + dy; // y-coord of center of circle
+    coord y = y_c - sqrt(dx*dx + dy*dy);
+    self->circle_event = Q.insert(Event(x,y,y_c,self)).first;
+    TRACE_COUNT("fortune/circle_push");
+    return;
+}
+
+inline void report_intersection(Arc arc, coord x_c, coord y_c){
+    auto ret = D.insert(Edge(arc.left, arc.middle, x_c, y_c));
+    if(!ret.second){
+        ret.first->second_vertex(x_c, y_c);
+    }
+    ret = D.insert(Edge(arc.middle, arc.right, x_c, y_c));
+    if(!ret.second){
+        ret.first->second_vertex(x_c, y_c);
+    }
+    ret = D.insert(Edge(arc.left, arc.right, x_c, y_c, false));
+    if(!ret.second){
+        ret.first->second_vertex(x_c, y_c);
+    }
+}
+
+inline void handleEvent(Event& event){
+    if(sweep_line_y != event.y){
+        sweep_line_y = event.y;
+        ++sweep_epoch;
+    }
+    if(event.isSite){
+        // Site Event
+        if(T.empty()){T.insert(Arc(NO_SITE, event.site, NO_SITE)); return;}
+        TRACE_COUNT("fortune/site_events");
+        auto it = T.upper_bound(event.x);
+        auto arc = *it;
+        
+        if(arc.circle_event != Q.end()){
+            Q.erase(arc.circle_event);
+            TRACE_COUNT("fortune/false_circle_events");
+        }
+        auto hint = std::next(it); // for O(1) inserts later
+        T.erase(it);
+        it = T.insert(hint, Arc(arc.left, arc.middle, event.site));
+        check_for_circle_event(it);
+        
+        if(K::close(sites[arc.middle].y, sweep_line_y)){
+            T.insert(hint, Arc(arc.middle, event.site, arc.right));
+        }else{
+            T.insert(hint, Arc(arc.middle, event.site, arc.middle));
+            it = T.insert(hint, Arc(event.site, arc.middle, arc.right));
+            check_for_circle_event(it);
+        }
+
+        // new edge starts between event.site and arc.middle
+
+    }else{
+        // Circle event
+        TRACE_COUNT("fortune/circle_events");
+        auto& it = event.arc;
+        auto left_it = std::prev(it);
+        auto right_it = std::next(it);
+        if(left_it->circle_event != Q.end()){
+            Q.erase(left_it->circle_event);
+            TRACE_COUNT("fortune/false_circle_events");
+        }
+        if(right_it->circle_event != Q.end()){
+            Q.erase(right_it->circle_event);
+            TRACE_COUNT("fortune/false_circle_events");
+        }
+        
+        auto left_arc = *left_it;
+        auto right_arc = *right_it;
+
+        auto arc = *it;
+        coord x_c = event.x;
+        coord y_c = event.y_c;
+
+        // the neighbours become neighbours of each other where they are: erasing and inserting them again would have to
+        // compare zero width arcs whose breakpoints are within the tolerance of each other, and can put them in the wrong order
+        T.erase(it);
+        left_it->right = right_arc.middle;
+        left_it->right_epoch = 0;
+        check_for_circle_event(left_it);
+        right_it->left = left_arc.middle;
+        right_it->left_epoch = 0;
+        check_for_circle_event(right_it);
+
+        report_intersection(arc, x_c, y_c);
+    }
+}
+
+// copies the n points xy (x0 y0 x1 y1 ...) into sites in Hilbert curve order, site i came from the pair site_id[i]
+inline void reorder_sites(const double* xy, std::size_t n){
+    site_id = hilbert_order(xy, n);
+    sites.resize(n);
+    for(std::size_t i=0; i<sites.size(); ++i){
+        sites[i].x = xy[2*site_id[i]];
+        sites[i].y = xy[2*site_id[i]+1];
+    }
+}
+inline void reorder_sites(const std::vector< double >& xy){reorder_sites(xy.data(), xy.size()/2);}
+
+// the diagram of the n points xy (x0 y0 x1 y1 ...), into D, with the sites in the order the sweep takes them in already
+// known: order is presort::sort_points(xy, PointOrder::by_y_descending, true), so Q fills up from one end
+// (the points order leaves out aren't sites of the diagram, a duplicate's cell is the first one's)
+// Q, T and D allocate from mem if given, from a fresh arena otherwise (the last run's is released here, D's edges with it)
+// xy is only read, from wherever it is (a mapped file, say), the sweep works on its own copy in sites
+inline void voronoi(const double* xy, std::size_t n, const std::vector< uint32_t >& order, std::pmr::memory_resource* mem = nullptr){
+    Q.clear();
+    T.clear();
+    D.clear();
+    memory.begin(mem);
+    sweep_line_y = -K::inf();
+    std::vector< uint32_t > site_of(n);    // inverse of site_id
+    {
+        TRACE_SCOPE("fortune/reorder");
+        reorder_sites(xy, n);
+        for(uint32_t i=0; i<site_id.size(); ++i){site_of[site_id[i]] = i;}
+    }
+    TRACE_SCOPE("fortune/sweep");
+    for(uint32_t k : order){
+        uint32_t i = site_of[k];
+        Q.emplace_hint(Q.end(), sites[i].x, sites[i].y, i);
+        if(sweep_line_y < sites[i].y){sweep_line_y = sites[i].y;}
+    }
+    ++sweep_epoch;
+    while(!Q.empty()){
+        if(!progress::report(sweep_line_y)){break;}    // stopped early, D has the edges the sweep line has reached
+        auto it = Q.begin();
+        Event event = *it;
+        Q.erase(it);
+        handleEvent(event);
+        TRACE_MAX("fortune/max_queue", Q.size());
+        TRACE_MAX("fortune/max_beachline", T.size());   // a red-black tree, so at most 2*log2(size+1) deep
+    }
+    TRACE_ADD("fortune/node_allocations", memory.stats().allocations);
+    TRACE_MAX("fortune/peak_node_bytes", memory.stats().peak_bytes);
+}
+
+inline void voronoi(const std::vector< double >& xy, const std::vector< uint32_t >& order, std::pmr::memory_resource* mem = nullptr){
+    voronoi(xy.data(), xy.size()/2, order, mem);
+}
+
+// the diagram of the n points xy (x0 y0 x1 y1 ...), into D, as above
+inline void voronoi(const double* xy, std::size_t n, std::pmr::memory_resource* mem = nullptr){
+    std::vector< uint32_t > order;
+    {
+        TRACE_SCOPE("fortune/presort");
+        order = presort::sort_points(xy, xy+1, 2, n, presort::PointOrder::by_y_descending, true);
+    }
+    voronoi(xy, n, order, mem);
+}
+inline void voronoi(const std::vector< double >& xy, std::pmr::memory_resource* mem = nullptr){
+    voronoi(xy.data(), xy.size()/2, mem);
+}
+
+// whether the diagram of n sites can have that many edges at all: its dual is planar, so 3n-6 at most (n-1 below 3 sites)
+inline bool possible_edge_count(std::size_t n, std::size_t edges){
+    if(n < 3){return edges + 1 <= n || edges == 0;}
+    return edges <= 3*n - 6;
+}
+
+}
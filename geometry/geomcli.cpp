@@ -0,0 +1,364 @@
+// command line front end to the geometry library, no window and no SFML
+// every command reads a file of points (text or binary, see loader.hpp, "-" is stdin) and writes its result to stdout as
+// plain text, one item per line; sizes and timings go to stderr so the output can be redirected as it is
+// run without arguments for the list of commands
+// built with -DGEOM_TRACE (make geomcli-trace), --trace and --chrome-trace write where the time went (see trace.hpp)
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "loader.hpp"
+#include "hull.hpp"
+#include "segments.hpp"
+#include "fortune.hpp"
+#include "incremental.hpp"
+#include "tiled.hpp"
+#include "graphs.hpp"
+#include "lloyd.hpp"
+#include "snapshot.hpp"
+#include "chains.hpp"
+#include "trace.hpp"
+
+TRACE_ALLOCATIONS()
+
+typedef std::chrono::steady_clock Clock;
+
+double ms_since(Clock::time_point t0){
+    return std::chrono::duration<double, std::milli>(Clock::now()-t0).count();
+}
+
+bool load(const char* path, std::vector< double >& xy){
+    bool ok = strcmp(path, "-") == 0 ? load_points(0, xy) : load_points(path, xy);
+    if(!ok){std::cerr << "could not read points from " << path << std::endl;}
+    return ok;
+}
+
+// what the sweep's node containers took from their arena (see arena.hpp)
+void print_memory(const MemoryStats& m){
+    std::cerr << "sweep nodes: " << m.allocations << ", " << m.bytes/1024 << " KB, peak in use " << m.peak_bytes/1024 << " KB" << std::endl;
+}
+
+// the hull of xy in coordinate type T, printed as cmd_hull does
+template< typename T >
+int print_hull(const std::vector< double >& xy, const char* kind){
+    std::vector< convex::BasicPoint< T > > points(xy.size()/2);
+    for(std::size_t i=0; i<points.size(); ++i){points[i] = convex::BasicPoint< T >{(T)xy[2*i], (T)xy[2*i+1]};}
+    auto t0 = Clock::now();
+    auto hull = convex::convex_hull(points);
+    double t = ms_since(t0);
+    if(!hull.empty()){hull.pop_back();}    // closed loop, first point again at the end
+    for(auto& p : hull){std::cout << p.x << ' ' << p.y << '\n';}
+    std::cerr << "hull points: " << hull.size() << " (" << points.size() << " read, " << kind << " coordinates)" << std::endl;
+    std::cerr << "hull ms: " << t << std::endl;
+    return 0;
+}
+
+// convex hull, counter-clockwise (on screen), one "x y" per line
+// integer input (below 2^30) gets the exact int32 kernel, anything else float as before (see coords.hpp)
+int cmd_hull(const char* path){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    bool integral = true;
+    for(double v : xy){integral = integral && v == std::floor(v) && std::abs(v) < (1 << 30);}
+    return integral ? print_hull< int32_t >(xy, "exact int32") : print_hull< float >(xy, "float");
+}
+
+// intersections of segments, consecutive points of the file are the ends of one segment (segment i is points 2i and 2i+1)
+// one "x y i j ..." per line, the intersection and the segments through it
+int cmd_intersections(const char* path){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    segments::lines.clear();
+    for(std::size_t i=0; i+3<xy.size(); i+=4){
+        segments::lines.push_back(segments::Line(xy[i], xy[i+1], xy[i+2], xy[i+3]));
+    }
+    auto t0 = Clock::now();
+    segments::find_intersections();
+    double t = ms_since(t0);
+    for(auto& e : segments::intersections){
+        std::cout << (double)e.at.x << ' ' << (double)e.at.y;
+        for(int id : e.lines){std::cout << ' ' << id;}
+        std::cout << '\n';
+    }
+    std::cerr << "segments: " << segments::lines.size() << (segments::lines.size() < segments::pairs_below ? " (all pairs)" : " (sweep)") << std::endl;
+    std::cerr << "intersections: " << segments::intersections.size() << std::endl;
+    print_memory(segments::memory.stats());
+    std::cerr << "sweep ms: " << t << std::endl;
+    return 0;
+}
+
+// Fortune's sweep, one "i j x1 y1 x2 y2 finite" per line: the voronoi edge between the cells of points i and j (which is also
+// the delaunay edge i-j), a ray is given by its start and a far point in its direction (finite = 0)
+int cmd_voronoi(const char* path){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    auto t0 = Clock::now();
+    fortune::voronoi(xy);
+    double t = ms_since(t0);
+    for(auto& e : fortune::D){
+        std::cout << fortune::site_id[e.p1] << ' ' << fortune::site_id[e.p2] << ' '
+                  << e.x1 << ' ' << e.y1 << ' ' << e.x2 << ' ' << e.y2 << ' ' << e.finite << '\n';
+    }
+    std::cerr << "voronoi/delaunay edges: " << fortune::D.size() << std::endl;
+    print_memory(fortune::memory.stats());
+    std::cerr << "sweep ms: " << t << std::endl;
+    return 0;
+}
+
+// incremental delaunay triangulation, one "i j k" per line (point indices, counter-clockwise on screen)
+// with tiles > 1 it's split into tiles x tiles pieces computed on separate threads (see tiled.hpp)
+int cmd_delaunay(const char* path, int tiles){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    auto t0 = Clock::now();
+    if(tiles > 1){
+        TiledDiagram td(xy, tiles, tiles);
+        double t = ms_since(t0);
+        for(auto& tri : td.triangles){std::cout << tri[0] << ' ' << tri[1] << ' ' << tri[2] << '\n';}
+        int rounds = 0, most = 0;
+        for(int r : td.tile_rounds){rounds += r;}
+        for(int m : td.tile_sites){most = std::max(most, m);}
+        std::cerr << "delaunay triangles: " << td.triangles.size() << std::endl;
+        std::cerr << "cell pieces: " << td.pieces.size() << std::endl;
+        std::cerr << "tiles redone: " << rounds << " times, largest tile: " << most << " sites" << std::endl;
+        std::cerr << "tiled ms: " << t << std::endl;
+        return 0;
+    }
+    Triangulation tr;
+    std::vector< int > handles;
+    triangulate(xy, tr, handles);
+    double t = ms_since(t0);
+    auto first = first_point(handles, tr.size());
+    int count = 0;
+    for(auto& T : tr.tris){
+        if(!T.alive || T.v[0] < Triangulation::SUPER || T.v[1] < Triangulation::SUPER || T.v[2] < Triangulation::SUPER){continue;}
+        std::cout << first[T.v[0]-Triangulation::SUPER] << ' ' << first[T.v[1]-Triangulation::SUPER] << ' ' << first[T.v[2]-Triangulation::SUPER] << '\n';
+        ++count;
+    }
+    std::cerr << "sites: " << tr.size() << " (" << xy.size()/2 << " read)" << std::endl;
+    std::cerr << "delaunay triangles: " << count << std::endl;
+    std::cerr << "triangulate ms: " << t << std::endl;
+    return 0;
+}
+
+// a graph on the sites as one "i j length" per edge (point indices, i < j)
+void print_graph(const Graph& g, const std::vector< int >& first){
+    for(int i=0; i<g.size(); ++i){
+        for(int k=g.offset[i]; k<g.offset[i+1]; ++k){
+            if(g.adj[k] < i){continue;}
+            int a = first[i], b = first[g.adj[k]];     // handles go in curve order, not in point order
+            std::cout << std::min(a, b) << ' ' << std::max(a, b) << ' ' << g.weight[k] << '\n';
+        }
+    }
+}
+
+// euclidean minimum spanning tree (see graphs.hpp)
+int cmd_emst(const char* path){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    auto t0 = Clock::now();
+    Triangulation tr;
+    std::vector< int > handles;
+    triangulate(xy, tr, handles);
+    Graph tree = emst(tr);
+    double t = ms_since(t0);
+    print_graph(tree, first_point(handles, tr.size()));
+    double total = 0;
+    for(double w : tree.weight){total += w;}
+    std::cerr << "tree length: " << total/2 << std::endl;
+    std::cerr << "emst ms: " << t << std::endl;
+    return 0;
+}
+
+// k nearest neighbours of every site (see graphs.hpp), one "i j distance" per line, i's neighbours nearest first
+int cmd_knn(const char* path, int k){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    auto t0 = Clock::now();
+    Triangulation tr;
+    std::vector< int > handles;
+    triangulate(xy, tr, handles);
+    Graph g = knn(tr, k);
+    double t = ms_since(t0);
+    auto first = first_point(handles, tr.size());
+    for(int i=0; i<g.size(); ++i){
+        for(int j=g.offset[i]; j<g.offset[i+1]; ++j){
+            std::cout << first[i] << ' ' << first[g.adj[j]] << ' ' << g.weight[j] << '\n';
+        }
+    }
+    std::cerr << "knn ms: " << t << std::endl;
+    return 0;
+}
+
+// Lloyd relaxation inside the bounding box of the points, the moved points as "x y" lines (same order as the input)
+int cmd_lloyd(const char* path, int iterations){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    if(xy.empty()){return 0;}
+    double x0 = xy[0], y0 = xy[1], x1 = xy[0], y1 = xy[1];
+    for(std::size_t i=0; i<xy.size()/2; ++i){
+        x0 = std::min(x0, xy[2*i]); x1 = std::max(x1, xy[2*i]);
+        y0 = std::min(y0, xy[2*i+1]); y1 = std::max(y1, xy[2*i+1]);
+    }
+    auto t0 = Clock::now();
+    Lloyd lloyd(xy, x0, y0, x1, y1);
+    int steps = lloyd.run(iterations);
+    double t = ms_since(t0);
+    auto& s = lloyd.sites();
+    for(std::size_t i=0; i<s.size()/2; ++i){std::cout << s[2*i] << ' ' << s[2*i+1] << '\n';}
+    std::cerr << "steps: " << steps << std::endl;
+    std::cerr << "lloyd ms: " << t << std::endl;
+    return 0;
+}
+
+// minimum chain decomposition (see chains.hpp), one "chain x y" per line in sweep order
+int cmd_chains(const char* path){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    std::vector< ChainPoint > points(xy.size()/2);
+    for(std::size_t i=0; i<points.size(); ++i){points[i] = ChainPoint{(float)xy[2*i], (float)xy[2*i+1]};}
+    auto t0 = Clock::now();
+    ChainDecomposition chains;
+    decompose(points, chains);
+    double t = ms_since(t0);
+    for(int p=0; p<chains.size(); ++p){std::cout << chains.chain_of[p] << ' ' << chains.xs[p] << ' ' << chains.ys[p] << '\n';}
+    std::cerr << "chains: " << chains.chains() << " (largest antichain: " << chains.antichain().size() << ")" << std::endl;
+    std::cerr << "chains ms: " << t << std::endl;
+    return 0;
+}
+
+// maxima layers (see chains.hpp), one "layer x y" per line in sweep order
+int cmd_layers(const char* path){
+    std::vector< double > xy;
+    if(!load(path, xy)){return 1;}
+    std::vector< ChainPoint > points(xy.size()/2);
+    for(std::size_t i=0; i<points.size(); ++i){points[i] = ChainPoint{(float)xy[2*i], (float)xy[2*i+1]};}
+    auto t0 = Clock::now();
+    parallel_sort(points);
+    std::vector< int > layer;
+    int layers = maxima_layers(points, layer);
+    double t = ms_since(t0);
+    for(std::size_t i=0; i<points.size(); ++i){std::cout << layer[i] << ' ' << points[i].x << ' ' << points[i].y << '\n';}
+    std::cerr << "layers: " << layers << std::endl;
+    std::cerr << "layers ms: " << t << std::endl;
+    return 0;
+}
+
+// chains of a (possibly huge) text file of "x y" lines, already sorted by x (for equal x by y, larger first),
+// written out as ChainRecords while reading, only the chain tails are ever held in memory
+int cmd_stream_chains(const char* in_path, const char* out_path){
+    FILE* in = strcmp(in_path, "-") == 0 ? stdin : fopen(in_path, "r");
+    if(!in){
+        std::cerr << "could not open " << in_path << std::endl;
+        return 1;
+    }
+    ChainStream out(out_path);
+    float x, y;
+    while(out.ok && fscanf(in, "%f %f", &x, &y) == 2){out.add(x, y);}
+    if(in != stdin){fclose(in);}
+    uint64_t n = out.size();
+    if(!out.close()){
+        std::cerr << "stopped after " << n << " points (out of order input or write error)" << std::endl;
+        return 1;
+    }
+    std::cerr << "points: " << n << std::endl;
+    std::cerr << "chains: " << out.chains() << std::endl;
+    return 0;
+}
+
+// triangulate and save the diagram as a snapshot (see snapshot.hpp)
+int cmd_snapshot(const char* in, const char* out){
+    std::vector< double > xy;
+    if(!load(in, xy)){return 1;}
+    Triangulation tr;
+    std::vector< int > handles;
+    triangulate(xy, tr, handles);
+    if(!save_snapshot(tr, out)){
+        std::cerr << "could not write " << out << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// map a snapshot and report what's in it
+int cmd_open_snapshot(const char* path){
+    auto t0 = Clock::now();
+    Snapshot snap(path);
+    double t = ms_since(t0);
+    if(!snap.ok){
+        std::cerr << path << " is not a diagram snapshot" << std::endl;
+        return 1;
+    }
+    std::cout << "sites: " << snap.size() << std::endl;
+    std::cout << "voronoi vertices: " << snap.head.finite_vertices << " (+" << snap.head.vertices-snap.head.finite_vertices << " at infinity)" << std::endl;
+    std::cout << "voronoi/delaunay edges: " << snap.head.edges << std::endl;
+    std::cerr << "open ms: " << t << std::endl;
+    return 0;
+}
+
+int usage(){
+    std::cerr <<
+        "usage: geomcli [--trace stats.json] [--chrome-trace trace.json] <command> <points> [args]\n"
+        "  (points: text or binary file, - for stdin, tracing needs a build with -DGEOM_TRACE)\n"
+        "  hull <points>                      convex hull\n"
+        "  intersections <points>             segment intersections (points 2i, 2i+1 are segment i)\n"
+        "  voronoi <points>                   voronoi/delaunay edges by Fortune's sweep\n"
+        "  delaunay <points> [tiles]          delaunay triangles, incremental (or tiled, on threads)\n"
+        "  emst <points>                      euclidean minimum spanning tree\n"
+        "  knn <points> <k>                   k nearest neighbours of every point\n"
+        "  lloyd <points> <iterations>        Lloyd relaxation inside the bounding box\n"
+        "  chains <points>                    minimum decomposition into monotone chains\n"
+        "  layers <points>                    maxima layers\n"
+        "  stream-chains <sorted.txt> <out>   chains of a presorted file, as binary records\n"
+        "  snapshot <points> <out>            save the diagram as a snapshot\n"
+        "  open-snapshot <snapshot>           map a snapshot and report its size\n"
+        "  to-binary <points> <out>           convert points to the binary format\n";
+    return 2;
+}
+
+int run(int argc, char** argv){
+    if(argc < 3){return usage();}
+    const char* cmd = argv[1];
+    const char* path = argv[2];
+    if(strcmp(cmd, "hull") == 0){return cmd_hull(path);}
+    if(strcmp(cmd, "intersections") == 0){return cmd_intersections(path);}
+    if(strcmp(cmd, "voronoi") == 0){return cmd_voronoi(path);}
+    if(strcmp(cmd, "delaunay") == 0){return cmd_delaunay(path, argc > 3 ? atoi(argv[3]) : 1);}
+    if(strcmp(cmd, "emst") == 0){return cmd_emst(path);}
+    if(strcmp(cmd, "knn") == 0 && argc > 3){return cmd_knn(path, atoi(argv[3]));}
+    if(strcmp(cmd, "lloyd") == 0 && argc > 3){return cmd_lloyd(path, atoi(argv[3]));}
+    if(strcmp(cmd, "chains") == 0){return cmd_chains(path);}
+    if(strcmp(cmd, "layers") == 0){return cmd_layers(path);}
+    if(strcmp(cmd, "stream-chains") == 0 && argc > 3){return cmd_stream_chains(path, argv[3]);}
+    if(strcmp(cmd, "snapshot") == 0 && argc > 3){return cmd_snapshot(path, argv[3]);}
+    if(strcmp(cmd, "open-snapshot") == 0){return cmd_open_snapshot(path);}
+    if(strcmp(cmd, "to-binary") == 0 && argc > 3){
+        std::vector< double > xy;
+        return (load(path, xy) && save_points_binary(argv[3], xy)) ? 0 : 1;
+    }
+    return usage();
+}
+
+int main(int argc, char** argv){
+    const char* stats = nullptr;
+    const char* chrome = nullptr;
+    while(argc > 2 && (strcmp(argv[1], "--trace") == 0 || strcmp(argv[1], "--chrome-trace") == 0)){
+        (strcmp(argv[1], "--trace") == 0 ? stats : chrome) = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+#ifndef GEOM_TRACE
+    if(stats || chrome){std::cerr << "built without GEOM_TRACE, nothing to trace (make geomcli-trace)" << std::endl;}
+#endif
+    int ret = run(argc, argv);
+#ifdef GEOM_TRACE
+    if(stats && !trace::write_json(stats)){std::cerr << "could not write " << stats << std::endl;}
+    if(chrome && !trace::write_chrome(chrome)){std::cerr << "could not write " << chrome << std::endl;}
+#endif
+    return ret;
+}
@@ -0,0 +1,478 @@
+// geomd, the geometry library as a long-running local service, for pipelines that would otherwise start geomcli (and
+// parse text) once per call. the protocol and the client side are in daemon.hpp
+//  geomd serve <socket> [threads]                   listens on socket until SIGINT/SIGTERM, runs requests on threads workers
+//  geomd call <socket> <command> <points> [repeat]  sends points to a running geomd and prints the result as geomcli does
+//                                                   (repeat > 1 sends that many copies of the request as one batch)
+// the main thread only accepts connections, reads batches and sends replies, every request of a batch goes into one queue
+// the workers take from, and the worker that finishes the last request of a batch hands its reply back to the main thread.
+// replies go out without waiting for room, a client that doesn't read its replies holds up no worker: its replies wait,
+// and nothing more is read from it until they're gone
+// hull, delaunay and chains keep all their state on the stack and run side by side on as many workers as there are, the two
+// sweeps (segments.hpp, fortune.hpp) keep theirs in namespace globals, so each of them runs one request at a time
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <poll.h>
+#include <fcntl.h>
+
+#include "daemon.hpp"
+#include "loader.hpp"
+#include "hull.hpp"
+#include "segments.hpp"
+#include "fortune.hpp"
+#include "incremental.hpp"
+#include "chains.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+double ms_since(Clock::time_point t0){
+    return std::chrono::duration<double, std::milli>(Clock::now()-t0).count();
+}
+
+// ---- server ----
+
+// a reply the client hasn't taken yet, with the results it hands over
+struct Outgoing{
+    std::vector< char > message;
+    std::vector< int > fds;
+    std::vector< SharedBuffer > results;    // own fds, until they're sent
+};
+
+struct Connection{
+    int fd;
+    std::mutex sending;     // outbox is filled by the workers and sent from by the main thread
+    std::deque< Outgoing > outbox;
+    Connection(int f) : fd(f){}
+    ~Connection(){close(fd);}
+};
+
+// a batch being worked on, replied to by whoever finishes its last request
+struct Pending{
+    std::shared_ptr< Connection > from;
+    uint64_t id;
+    std::vector< DaemonReply > replies;
+    std::vector< SharedBuffer > results;
+    std::atomic< int > left;
+};
+
+struct Job{
+    std::shared_ptr< Pending > batch;
+    int index;
+    DaemonRequest request;
+    int fd;                 // the request's buffer, the job closes it
+};
+
+std::mutex queue_lock;
+std::condition_variable queue_ready;
+std::deque< Job > queue;
+bool closing = false;
+
+std::mutex segments_lock, fortune_lock;
+
+int wake[2] = {-1, -1};     // a byte in wake[1] has the main thread look for replies to send
+
+// fills out with the result of one request on the count points at xy, returns its item count (DaemonReply::count)
+template< typename T >
+uint64_t run_hull(const double* xy, uint64_t n, SharedBuffer& out, bool& ok){
+    std::vector< convex::BasicPoint< T > > points(n);
+    for(uint64_t i=0; i<n; ++i){points[i] = convex::BasicPoint< T >{(T)xy[2*i], (T)xy[2*i+1]};}
+    auto hull = convex::convex_hull(points);
+    if(!hull.empty()){hull.pop_back();}    // closed loop, first point again at the end
+    ok = out.create(hull.size()*2*sizeof(double), "geomd-hull");
+    if(!ok){return 0;}
+    double* p = (double*)out.data;
+    for(std::size_t i=0; i<hull.size(); ++i){p[2*i] = hull[i].x; p[2*i+1] = hull[i].y;}
+    return hull.size();
+}
+
+uint64_t run_intersections(const double* xy, uint64_t n, SharedBuffer& out, bool& ok){
+    std::lock_guard< std::mutex > hold(segments_lock);
+    segments::lines.clear();
+    for(uint64_t i=0; i+1<n; i+=2){
+        segments::lines.push_back(segments::Line(xy[2*i], xy[2*i+1], xy[2*i+2], xy[2*i+3]));
+    }
+    segments::find_intersections();
+    std::size_t count = segments::intersections.size(), ids = 0;
+    for(auto& e : segments::intersections){ids += e.lines.size();}
+    ok = out.create(count*2*sizeof(double) + (count+1)*sizeof(uint64_t) + ids*sizeof(uint32_t), "geomd-intersections");
+    if(!ok){return 0;}
+    double* at = (double*)out.data;
+    uint64_t* offset = (uint64_t*)(at + 2*count);
+    uint32_t* id = (uint32_t*)(offset + count+1);
+    offset[0] = 0;
+    for(std::size_t k=0; k<count; ++k){
+        auto& e = segments::intersections[k];
+        at[2*k] = e.at.x;
+        at[2*k+1] = e.at.y;
+        for(int l : e.lines){*id++ = l;}
+        offset[k+1] = offset[k] + e.lines.size();
+    }
+    return count;
+}
+
+uint64_t run_voronoi(const double* xy, uint64_t n, SharedBuffer& out, bool& ok){
+    std::lock_guard< std::mutex > hold(fortune_lock);
+    fortune::voronoi(xy, n);   // straight from the caller's mapping
+    ok = fortune::possible_edge_count(n, fortune::D.size());    // a broken sweep, not a diagram
+    if(!ok){return 0;}
+    ok = out.create(fortune::D.size()*sizeof(DaemonEdge), "geomd-voronoi");
+    if(!ok){return 0;}
+    DaemonEdge* edge = (DaemonEdge*)out.data;
+    for(auto& e : fortune::D){
+        *edge++ = DaemonEdge{(uint32_t)fortune::site_id[e.p1], (uint32_t)fortune::site_id[e.p2], e.finite, 0,
+                             (double)e.x1, (double)e.y1, (double)e.x2, (double)e.y2};
+    }
+    return fortune::D.size();
+}
+
+uint64_t run_delaunay(const double* xy, uint64_t n, SharedBuffer& out, bool& ok){
+    Triangulation tr;
+    std::vector< int > handles;
+    triangulate(xy, n, tr, handles);
+    auto first = first_point(handles, tr.size());
+    const int SUPER = Triangulation::SUPER;
+    std::vector< uint32_t > tris;
+    for(auto& T : tr.tris){
+        if(!T.alive || T.v[0] < SUPER || T.v[1] < SUPER || T.v[2] < SUPER){continue;}
+        for(int k=0; k<3; ++k){tris.push_back(first[T.v[k]-SUPER]);}
+    }
+    ok = out.create(tris.size()*sizeof(uint32_t), "geomd-delaunay");
+    if(!ok){return 0;}
+    if(!tris.empty()){memcpy(out.data, tris.data(), tris.size()*sizeof(uint32_t));}
+    return tris.size()/3;
+}
+
+uint64_t run_chains(const double* xy, uint64_t n, SharedBuffer& out, bool& ok){
+    std::vector< ChainPoint > points(n);
+    for(uint64_t i=0; i<n; ++i){points[i] = ChainPoint{(float)xy[2*i], (float)xy[2*i+1]};}
+    ChainDecomposition chains;
+    decompose(points, chains, 1);   // the other workers have the other cores
+    ok = out.create(chains.size()*sizeof(ChainRecord), "geomd-chains");
+    if(!ok){return 0;}
+    ChainRecord* r = (ChainRecord*)out.data;
+    for(int p=0; p<chains.size(); ++p){r[p] = ChainRecord{(uint32_t)chains.chain_of[p], chains.xs[p], chains.ys[p]};}
+    return chains.size();
+}
+
+DaemonReply run(const DaemonRequest& q, int fd, SharedBuffer& out){
+    DaemonReply r{DAEMON_OK, q.op, 0, 0};
+    if(q.op < DAEMON_HULL || q.op > DAEMON_CHAINS || q.count >= (1u << 31)){r.status = DAEMON_BAD_REQUEST; return r;}
+    struct stat st;
+    int seals = fcntl(fd, F_GET_SEALS);
+    if(fstat(fd, &st) != 0 || seals < 0 || !(seals & F_SEAL_SHRINK) || q.offset%8 != 0
+       || (uint64_t)st.st_size < q.offset || ((uint64_t)st.st_size-q.offset)/16 < q.count){
+        r.status = DAEMON_BAD_BUFFER;
+        return r;
+    }
+    SharedBuffer in;
+    if(!in.map(dup(fd), st.st_size)){r.status = DAEMON_FAILED; return r;}
+    const double* xy = (const double*)(in.data + q.offset);
+    bool ok = true;
+    switch(q.op){
+        case DAEMON_HULL:{
+            bool integral = true;
+            for(uint64_t i=0; i<2*q.count && integral; ++i){integral = xy[i] == std::floor(xy[i]) && std::abs(xy[i]) < (1 << 30);}
+            r.count = integral ? run_hull< int32_t >(xy, q.count, out, ok) : run_hull< float >(xy, q.count, out, ok);
+            break;
+        }
+        case DAEMON_INTERSECTIONS: r.count = run_intersections(xy, q.count, out, ok); break;
+        case DAEMON_VORONOI: r.count = run_voronoi(xy, q.count, out, ok); break;
+        case DAEMON_DELAUNAY: r.count = run_delaunay(xy, q.count, out, ok); break;
+        case DAEMON_CHAINS: r.count = run_chains(xy, q.count, out, ok); break;
+    }
+    if(!ok){r.status = DAEMON_FAILED; r.count = 0; return r;}
+    r.bytes = out.bytes;
+    return r;
+}
+
+// queues a finished batch's reply on its connection, for the main thread to send
+void reply(Pending& batch){
+    DaemonBatch head{DAEMON_MAGIC, (uint32_t)batch.replies.size(), batch.id};
+    Outgoing out;
+    out.message.resize(sizeof(head) + sizeof(DaemonReply)*batch.replies.size());
+    memcpy(out.message.data(), &head, sizeof(head));
+    memcpy(out.message.data()+sizeof(head), batch.replies.data(), sizeof(DaemonReply)*batch.replies.size());
+    for(std::size_t i=0; i<batch.replies.size(); ++i){
+        if(batch.replies[i].status == DAEMON_OK){out.fds.push_back(batch.results[i].fd);}
+    }
+    out.results = std::move(batch.results);
+    {
+        std::lock_guard< std::mutex > hold(batch.from->sending);
+        batch.from->outbox.push_back(std::move(out));
+    }
+    char byte = 0;
+    ssize_t w = write(wake[1], &byte, 1);   // a full pipe has a wake up pending already
+    (void)w;
+}
+
+// sends what the client has room for, false once it's gone
+bool flush(Connection& to){
+    std::lock_guard< std::mutex > hold(to.sending);
+    while(!to.outbox.empty()){
+        auto& out = to.outbox.front();
+        if(!send_with_fds(to.fd, out.message, out.fds, MSG_DONTWAIT)){
+            if(errno == EAGAIN || errno == EWOULDBLOCK){return true;}  // the rest when poll says there's room
+            to.outbox.clear();
+            return false;
+        }
+        to.outbox.pop_front();
+    }
+    return true;
+}
+
+// what to wait for on a client: room for its replies if any are waiting, its next batch otherwise
+short interest(Connection& c){
+    std::lock_guard< std::mutex > hold(c.sending);
+    return c.outbox.empty() ? POLLIN : POLLOUT;
+}
+
+void worker(){
+    while(true){
+        Job job;
+        {
+            std::unique_lock< std::mutex > hold(queue_lock);
+            queue_ready.wait(hold, [](){return closing || !queue.empty();});
+            if(queue.empty()){return;}
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        Pending& batch = *job.batch;
+        if(job.fd < 0){
+            batch.replies[job.index] = DaemonReply{DAEMON_BAD_BUFFER, job.request.op, 0, 0};
+        }else{
+            batch.replies[job.index] = run(job.request, job.fd, batch.results[job.index]);
+            close(job.fd);
+        }
+        if(--batch.left == 0){reply(batch);}
+    }
+}
+
+// reads one batch off a client and queues its requests, false once the client is gone (or broke the protocol)
+bool read_batch(const std::shared_ptr< Connection >& from){
+    std::vector< char > message(batch_message_size());
+    std::vector< int > fds;
+    ssize_t n = receive_with_fds(from->fd, message, fds);
+    DaemonBatch head;
+    bool ok = n >= (ssize_t)sizeof(head);
+    if(ok){
+        memcpy(&head, message.data(), sizeof(head));
+        ok = head.magic == DAEMON_MAGIC && head.size > 0 && head.size <= (uint32_t)DAEMON_MAX_BATCH
+          && (std::size_t)n == sizeof(head) + sizeof(DaemonRequest)*head.size && fds.size() <= head.size;
+    }
+    if(!ok){
+        for(int fd : fds){close(fd);}
+        return false;
+    }
+    auto batch = std::make_shared< Pending >();
+    batch->from = from;
+    batch->id = head.id;
+    batch->replies.resize(head.size);
+    batch->results.resize(head.size);
+    batch->left = head.size;
+    {
+        std::lock_guard< std::mutex > hold(queue_lock);
+        for(uint32_t i=0; i<head.size; ++i){
+            Job job{batch, (int)i, {}, i < fds.size() ? fds[i] : -1};
+            memcpy(&job.request, message.data()+sizeof(head)+i*sizeof(DaemonRequest), sizeof(DaemonRequest));
+            queue.push_back(std::move(job));
+        }
+    }
+    queue_ready.notify_all();
+    return true;
+}
+
+volatile sig_atomic_t quit = 0;
+
+int serve(const char* path, int threads){
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path)){
+        std::cerr << "socket path too long: " << path << std::endl;
+        return 1;
+    }
+    strcpy(addr.sun_path, path);
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    unlink(path);   // left over from a geomd that didn't shut down
+    if(listener < 0 || bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0){
+        std::cerr << "could not listen on " << path << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+    struct sigaction sa{};
+    sa.sa_handler = [](int){quit = 1;};
+    sigaction(SIGINT, &sa, nullptr);    // no SA_RESTART, poll returns with EINTR
+    sigaction(SIGTERM, &sa, nullptr);
+
+    if(pipe2(wake, O_CLOEXEC | O_NONBLOCK) != 0){
+        std::cerr << "could not make a pipe: " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+    std::vector< std::thread > pool;
+    for(int t=0; t<threads; ++t){pool.emplace_back(worker);}
+    std::cerr << "geomd on " << path << ", " << threads << " workers" << std::endl;
+
+    std::vector< pollfd > watch{{listener, POLLIN, 0}, {wake[0], POLLIN, 0}};
+    std::vector< std::shared_ptr< Connection > > clients{nullptr, nullptr};  // clients[i] is watch[i]'s
+    while(!quit){
+        if(poll(watch.data(), watch.size(), -1) < 0){
+            if(errno == EINTR){continue;}
+            break;
+        }
+        bool woken = watch[1].revents & POLLIN;
+        if(woken){
+            char bytes[64];
+            while(read(wake[0], bytes, sizeof(bytes)) > 0){}
+        }
+        for(std::size_t i=watch.size(); i-- > 2;){
+            short got = watch[i].revents;
+            bool alive = true;
+            if(woken || (got & POLLOUT)){alive = flush(*clients[i]);}
+            if(alive && (got & POLLIN)){alive = read_batch(clients[i]);}
+            else if(alive && (got & (POLLHUP | POLLERR | POLLNVAL))){alive = false;}
+            if(alive){
+                watch[i].events = interest(*clients[i]);
+                continue;
+            }
+            // gone: batches still in the queue hold on to the connection until they're replied to (into the void)
+            watch.erase(watch.begin()+i);
+            clients.erase(clients.begin()+i);
+        }
+        if(watch[0].revents & POLLIN){
+            int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if(fd >= 0){
+                watch.push_back(pollfd{fd, POLLIN, 0});
+                clients.push_back(std::make_shared< Connection >(fd));
+            }
+        }
+    }
+
+    {
+        std::lock_guard< std::mutex > hold(queue_lock);
+        closing = true;     // the workers finish what's queued first
+    }
+    queue_ready.notify_all();
+    for(auto& t : pool){t.join();}
+    for(std::size_t i=2; i<clients.size(); ++i){flush(*clients[i]);}  // what still fits, the rest is dropped
+    close(listener);
+    close(wake[0]);
+    close(wake[1]);
+    unlink(path);
+    return 0;
+}
+
+// ---- client ----
+
+// prints a result in geomcli's format (see there)
+void print_result(uint32_t op, const DaemonReply& r, const SharedBuffer& result){
+    const char* p = result.data;
+    switch(op){
+        case DAEMON_HULL:{
+            const double* xy = (const double*)p;
+            for(uint64_t i=0; i<r.count; ++i){std::cout << xy[2*i] << ' ' << xy[2*i+1] << '\n';}
+            break;
+        }
+        case DAEMON_INTERSECTIONS:{
+            const double* at = (const double*)p;
+            const uint64_t* offset = (const uint64_t*)(at + 2*r.count);
+            const uint32_t* id = (const uint32_t*)(offset + r.count+1);
+            for(uint64_t k=0; k<r.count; ++k){
+                std::cout << at[2*k] << ' ' << at[2*k+1];
+                for(uint64_t j=offset[k]; j<offset[k+1]; ++j){std::cout << ' ' << id[j];}
+                std::cout << '\n';
+            }
+            break;
+        }
+        case DAEMON_VORONOI:{
+            const DaemonEdge* e = (const DaemonEdge*)p;
+            for(uint64_t k=0; k<r.count; ++k, ++e){
+                std::cout << e->i << ' ' << e->j << ' ' << e->x1 << ' ' << e->y1 << ' ' << e->x2 << ' ' << e->y2 << ' ' << e->finite << '\n';
+            }
+            break;
+        }
+        case DAEMON_DELAUNAY:{
+            const uint32_t* t = (const uint32_t*)p;
+            for(uint64_t k=0; k<r.count; ++k){std::cout << t[3*k] << ' ' << t[3*k+1] << ' ' << t[3*k+2] << '\n';}
+            break;
+        }
+        case DAEMON_CHAINS:{
+            const ChainRecord* c = (const ChainRecord*)p;
+            for(uint64_t k=0; k<r.count; ++k){std::cout << c[k].chain << ' ' << c[k].x << ' ' << c[k].y << '\n';}
+            break;
+        }
+    }
+}
+
+int call(const char* path, const char* cmd, const char* points, int repeat){
+    const char* names[] = {"hull", "intersections", "voronoi", "delaunay", "chains"};
+    uint32_t op = 0;
+    for(uint32_t k=0; k<5; ++k){if(strcmp(cmd, names[k]) == 0){op = DAEMON_HULL+k;}}
+    if(op == 0){
+        std::cerr << "unknown command " << cmd << std::endl;
+        return 2;
+    }
+    repeat = std::max(1, std::min(repeat, DAEMON_MAX_BATCH));
+    std::vector< double > xy;
+    if(!(strcmp(points, "-") == 0 ? load_points(0, xy) : load_points(points, xy))){
+        std::cerr << "could not read points from " << points << std::endl;
+        return 1;
+    }
+    // a pipeline would write its points straight into the buffer instead of copying them in
+    SharedBuffer input;
+    if(!input.create(xy.size()*sizeof(double), "geomd-points")){
+        std::cerr << "could not make a shared buffer: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    if(!xy.empty()){memcpy(input.data, xy.data(), xy.size()*sizeof(double));}
+
+    DaemonClient client(path);
+    if(!client.ok()){
+        std::cerr << "no geomd on " << path << std::endl;
+        return 1;
+    }
+    std::vector< DaemonRequest > requests(repeat, DaemonRequest{op, 0, xy.size()/2, 0});
+    std::vector< int > fds(repeat, input.fd);
+    std::vector< DaemonReply > replies;
+    std::vector< SharedBuffer > results;
+    auto t0 = Clock::now();
+    if(!client.call(requests, fds, replies, results)){
+        std::cerr << "geomd on " << path << " didn't answer" << std::endl;
+        return 1;
+    }
+    double t = ms_since(t0);
+    for(auto& r : replies){
+        if(r.status != DAEMON_OK){
+            std::cerr << "request failed with status " << r.status << std::endl;
+            return 1;
+        }
+    }
+    print_result(op, replies[0], results[0]);
+    std::cerr << "items: " << replies[0].count << " (" << xy.size()/2 << " points sent)" << std::endl;
+    std::cerr << "batch of " << repeat << " ms: " << t << std::endl;
+    return 0;
+}
+
+int usage(){
+    std::cerr <<
+        "usage: geomd serve <socket> [threads]\n"
+        "       geomd call <socket> <command> <points> [repeat]\n"
+        "  (command: hull, intersections, voronoi, delaunay or chains, output as geomcli's)\n";
+    return 2;
+}
+
+int main(int argc, char** argv){
+    if(argc > 2 && strcmp(argv[1], "serve") == 0){return serve(argv[2], argc > 3 ? atoi(argv[3]) : 0);}
+    if(argc > 4 && strcmp(argv[1], "call") == 0){return call(argv[2], argv[3], argv[4], argc > 5 ? atoi(argv[5]) : 1);}
+    return usage();
+}
@@ -0,0 +1,311 @@
+// graphs derived from a computed Delaunay triangulation, no brute force and no k-d tree needed:
+//  emst: the Euclidean minimum spanning tree is a subgraph of the Delaunay graph, so Kruskal only has to look at its
+//        O(n) edges instead of all n^2 pairs
+//  knn:  the i-th nearest neighbour of a site is a Delaunay neighbour of the site itself or of one of its first i-1
+//        nearest neighbours, so a best-first expansion over the Delaunay graph that stops after k sites is exact
+// both are O(n log n), vertices are site handles of the Triangulation, results are in compressed sparse row form
+// IncrementalEmst keeps the emst up to date while sites are inserted one at a time
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+#include "incremental.hpp"
+
+// neighbours of vertex i are adj[offset[i] .. offset[i+1]), weight[k] is the length of the edge to adj[k]
+struct Graph{
+    std::vector< int > offset;
+    std::vector< int > adj;
+    std::vector< double > weight;
+
+    int size() const {return (int)offset.size() - 1;}
+};
+
+// run f(begin, end) over [0, n) split into contiguous parts on up to threads threads (0 means one per core)
+template< typename F >
+void parallel_for(int n, int threads, F f){
+    if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+    threads = std::max(1, std::min(threads, n/1024));
+    std::vector< std::thread > pool;
+    for(int t=1; t<threads; ++t){pool.emplace_back(f, (long long)n*t/threads, (long long)n*(t+1)/threads);}
+    f(0, n/threads);
+    for(auto& th : pool){th.join();}
+}
+
+// undirected graph out of an edge list (every edge shows up in both rows)
+inline Graph make_graph(int n, const std::vector< std::pair<int,int> >& edges, const std::vector< double >& length){
+    Graph g;
+    g.offset.assign(n+1, 0);
+    for(auto& e : edges){++g.offset[e.first+1]; ++g.offset[e.second+1];}
+    for(int i=0; i<n; ++i){g.offset[i+1] += g.offset[i];}
+    g.adj.resize(g.offset[n]);
+    g.weight.resize(g.offset[n]);
+    std::vector< int > fill(g.offset.begin(), g.offset.end()-1);
+    for(std::size_t k=0; k<edges.size(); ++k){
+        int a = edges[k].first, b = edges[k].second;
+        g.adj[fill[a]] = b; g.weight[fill[a]++] = length[k];
+        g.adj[fill[b]] = a; g.weight[fill[b]++] = length[k];
+    }
+    return g;
+}
+
+class UnionFind{
+        std::vector< int > parent, size;
+    public:
+        UnionFind(int n) : parent(n), size(n, 1){
+            for(int i=0; i<n; ++i){parent[i] = i;}
+        }
+        int find(int a){
+            while(parent[a] != a){
+                parent[a] = parent[parent[a]];  // path halving
+                a = parent[a];
+            }
+            return a;
+        }
+        // false if a and b were already together
+        bool unite(int a, int b){
+            a = find(a); b = find(b);
+            if(a == b){return false;}
+            if(size[a] < size[b]){std::swap(a, b);}
+            parent[b] = a;
+            size[a] += size[b];
+            return true;
+        }
+};
+
+// Euclidean minimum spanning tree (a forest only if there are no sites), as a graph over all site handles
+// edges are measured in parallel and sorted in parallel chunks that are then merged, the union-find pass is sequential
+inline Graph emst(const Triangulation& tr, int threads = 0){
+    int n = tr.size();
+    auto edges = tr.delaunay_edges();
+    int m = edges.size();
+    std::vector< double > length(m);
+    std::vector< int > order(m);
+    parallel_for(m, threads, [&](int begin, int end){
+        for(int k=begin; k<end; ++k){
+            auto& a = tr.site(edges[k].first);
+            auto& b = tr.site(edges[k].second);
+            length[k] = std::hypot(a.x-b.x, a.y-b.y);
+            order[k] = k;
+        }
+    });
+
+    // ties broken by index so the tree doesn't depend on the number of threads
+    auto shorter = [&](int a, int b){return length[a] < length[b] || (length[a] == length[b] && a < b);};
+    if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+    int parts = std::max(1, std::min(threads, m/1024));     // the split parallel_for makes, one sorted run per part
+    parallel_for(m, parts, [&](int begin, int end){std::sort(order.begin()+begin, order.begin()+end, shorter);});
+    std::vector< int > bounds;
+    for(int t=0; t<=parts; ++t){bounds.push_back((long long)m*t/parts);}
+    while(bounds.size() > 2){
+        std::vector< int > merged;
+        for(std::size_t i=0; i+2<bounds.size(); i+=2){
+            std::inplace_merge(order.begin()+bounds[i], order.begin()+bounds[i+1], order.begin()+bounds[i+2], shorter);
+            merged.push_back(bounds[i]);
+        }
+        if(bounds.size()%2 == 0){merged.push_back(bounds[bounds.size()-2]);}
+        merged.push_back(bounds.back());
+        bounds.swap(merged);
+    }
+
+    UnionFind uf(n);
+    std::vector< std::pair<int,int> > tree;
+    std::vector< double > tree_length;
+    tree.reserve(std::max(n-1, 0));
+    tree_length.reserve(std::max(n-1, 0));
+    for(int k : order){
+        if(uf.unite(edges[k].first, edges[k].second)){
+            tree.push_back(edges[k]);
+            tree_length.push_back(length[k]);
+            if((int)tree.size() == n-1){break;}
+        }
+    }
+    return make_graph(n, tree, tree_length);
+}
+
+// the EMST kept up to date while sites go into the triangulation one at a time (the demos' clicks): the new site's tree
+// edges are among its Delaunay edges, and each of those closes a cycle in the old tree whose longest edge is the one to
+// drop (the cycle property), so an insertion only walks the tree around those cycles instead of running Kruskal again
+// edges keep their index while they're in the tree, a dropped edge's index goes to the edge that replaces it
+class IncrementalEmst{
+        const Triangulation& tr;
+        std::vector< std::pair<int,int> > tree;     // edge k joins sites tree[k].first and tree[k].second
+        std::vector< std::vector< int > > at;       // site -> the edges at it
+        std::vector< int > changed;
+
+        // path search scratch: per site the edge the search came in on (-1 where it started, -2 if it hasn't got there)
+        // and which end of the search got there
+        std::vector< int > reached_by;
+        std::vector< char > side;
+        std::vector< int > seen, level[2], next;
+
+        double length(int a, int b) const {
+            auto& p = tr.site(a);
+            auto& q = tr.site(b);
+            return std::hypot(p.x-q.x, p.y-q.y);
+        }
+        double length(int k) const {return length(tree[k].first, tree[k].second);}
+        int other(int k, int v) const {return tree[k].first == v ? tree[k].second : tree[k].first;}
+
+        void link(int k, int a, int b){
+            tree[k] = {a, b};
+            at[a].push_back(k);
+            at[b].push_back(k);
+        }
+        void unlink(int k){
+            for(int v : {tree[k].first, tree[k].second}){at[v].erase(std::find(at[v].begin(), at[v].end(), k));}
+        }
+
+        // the longest edge on the tree's path from a to b, -1 if they aren't connected
+        // searched breadth first from both ends, the smaller frontier a level at a time, until the two meet: it only sees the
+        // part of the tree around the path (sites that are close are usually close in the tree as well)
+        int longest_on_path(int a, int b){
+            reached_by.resize(at.size(), -2);
+            side.resize(at.size());
+            seen.assign({a, b});
+            level[0].assign(1, a);
+            level[1].assign(1, b);
+            reached_by[a] = reached_by[b] = -1;
+            side[a] = 0;
+            side[b] = 1;
+            int meet = -1, u = -1;      // the edge where the searches met, and its end that was reached from a
+            while(meet < 0 && !level[0].empty() && !level[1].empty()){
+                int s = level[0].size() <= level[1].size() ? 0 : 1;
+                next.clear();
+                for(int v : level[s]){
+                    for(int k : at[v]){
+                        if(k == reached_by[v]){continue;}
+                        int w = other(k, v);
+                        if(reached_by[w] != -2){
+                            if(side[w] != s){meet = k; u = (s == 0) ? v : w;}
+                            continue;
+                        }
+                        reached_by[w] = k;
+                        side[w] = s;
+                        seen.push_back(w);
+                        next.push_back(w);
+                    }
+                    if(meet >= 0){break;}
+                }
+                level[s].swap(next);
+            }
+            int longest = meet;
+            if(meet >= 0){
+                double l = length(meet);
+                for(int v : {u, other(meet, u)}){
+                    while(reached_by[v] >= 0){
+                        int k = reached_by[v];
+                        if(length(k) > l){longest = k; l = length(k);}
+                        v = other(k, v);
+                    }
+                }
+            }
+            for(int v : seen){reached_by[v] = -2;}
+            return longest;
+        }
+
+    public:
+        IncrementalEmst(const Triangulation& tr) : tr(tr){reset();}
+
+        // the tree of the sites there are now, from scratch or from emst(tr) computed already (on another thread, say)
+        void reset(){reset(emst(tr));}
+        void reset(const Graph& g){
+            tree.clear();
+            at.assign(tr.size(), std::vector< int >());
+            for(int i=0; i<g.size(); ++i){
+                for(int k=g.offset[i]; k<g.offset[i+1]; ++k){
+                    if(g.adj[k] < i){continue;}
+                    tree.push_back({});
+                    link(tree.size()-1, i, g.adj[k]);
+                }
+            }
+        }
+
+        // call after every tr.insert() that added a site, takes in its Delaunay edges (the new site's star is
+        // tr.created(), each triangle of it is (site, a, b) with a and b neighbours), returns the edges that changed
+        const std::vector< int >& update(){
+            changed.clear();
+            auto& star = tr.created();
+            if(star.empty()){return changed;}
+            int h = tr.tris[star[0]].v[0] - Triangulation::SUPER;
+            at.resize(tr.size());
+            std::vector< std::pair<double,int> > edges;
+            for(int t : star){
+                int v = tr.tris[t].v[1];
+                if(!tr.is_super(v)){edges.push_back({length(h, v - Triangulation::SUPER), v - Triangulation::SUPER});}
+            }
+            std::sort(edges.begin(), edges.end());     // the shortest one just joins h on
+            for(auto& e : edges){
+                int k = longest_on_path(e.second, h);
+                if(k < 0){
+                    k = tree.size();
+                    tree.push_back({});
+                }else if(e.first < length(k)){
+                    unlink(k);
+                }else{
+                    continue;
+                }
+                link(k, h, e.second);
+                changed.push_back(k);
+            }
+            return changed;
+        }
+
+        int size() const {return tree.size();}
+        const std::pair<int,int>& edge(int k) const {return tree[k];}
+};
+
+// directed k-nearest-neighbour graph: row i holds the min(k, n-1) sites closest to site i, nearest first
+// every site is expanded on its own (in parallel), visiting only O(k) sites with a small heap
+inline Graph knn(const Triangulation& tr, int k, int threads = 0){
+    int n = tr.size();
+    auto edges = tr.delaunay_edges();
+    std::vector< double > unused(edges.size());
+    Graph delaunay = make_graph(n, edges, unused);
+
+    int row = std::max(0, std::min(k, n-1));
+    Graph g;
+    g.offset.resize(n+1);
+    for(int i=0; i<=n; ++i){g.offset[i] = i*row;}
+    g.adj.resize((std::size_t)n*row);
+    g.weight.resize((std::size_t)n*row);
+
+    parallel_for(n, threads, [&](int begin, int end){
+        std::vector< int > seen;                                // sites pushed during the current expansion
+        std::vector< char > pushed(n, 0);
+        std::vector< std::pair<double,int> > heap;              // (squared distance, site), min-heap through std::greater
+        for(int i=begin; i<end; ++i){
+            auto& p = tr.site(i);
+            auto push = [&](int v){
+                if(pushed[v]){return;}
+                pushed[v] = 1;
+                seen.push_back(v);
+                auto& q = tr.site(v);
+                heap.push_back({(q.x-p.x)*(q.x-p.x) + (q.y-p.y)*(q.y-p.y), v});
+                std::push_heap(heap.begin(), heap.end(), std::greater< std::pair<double,int> >());
+            };
+            push(i);
+            std::pop_heap(heap.begin(), heap.end(), std::greater< std::pair<double,int> >());
+            heap.pop_back();
+            for(int j=delaunay.offset[i]; j<delaunay.offset[i+1]; ++j){push(delaunay.adj[j]);}
+            for(int found=0; found<row; ++found){
+                auto top = heap.front();
+                std::pop_heap(heap.begin(), heap.end(), std::greater< std::pair<double,int> >());
+                heap.pop_back();
+                g.adj[(std::size_t)i*row + found] = top.second;
+                g.weight[(std::size_t)i*row + found] = std::sqrt(top.first);
+                if(found+1 < row){
+                    for(int j=delaunay.offset[top.second]; j<delaunay.offset[top.second+1]; ++j){push(delaunay.adj[j]);}
+                }
+            }
+            for(int v : seen){pushed[v] = 0;}
+            seen.clear();
+            heap.clear();
+        }
+    });
+    return g;
+}
@@ -0,0 +1,52 @@
+// spatial (Hilbert curve) ordering of point sets, used to renumber sites so that sites close in the plane are close in memory
+// consecutive points along the curve are always neighbours, so walks, sweeps and insertions that go through the sites
+// in this order keep touching the same few cache lines instead of jumping across the whole array
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+#include "presort.hpp"
+
+// position of the cell (x,y) along the Hilbert curve through a 2^16 x 2^16 grid
+inline uint64_t hilbert_key(uint32_t x, uint32_t y){
+    uint64_t key = 0;
+    for(uint32_t s = 1u<<15; s > 0; s >>= 1){
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        key += (uint64_t)s*s*((3*rx) ^ ry);
+        // rotate the quadrant so that the curve inside it starts and ends where the parent curve expects
+        if(ry == 0){
+            if(rx == 1){
+                x = s-1 - (x & (s-1));
+                y = s-1 - (y & (s-1));
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+// permutation of the n points in xy (x0,y0,x1,y1,...) along the Hilbert curve over their bounding box:
+// order[k] is the original index of the k-th point on the curve (ties keep their input order)
+inline std::vector< uint32_t > hilbert_order(const double* xy, std::size_t n){
+    std::vector< uint32_t > order(n);
+    if(n == 0){return order;}
+    double x_min = xy[0], x_max = xy[0], y_min = xy[1], y_max = xy[1];
+    for(std::size_t i=1; i<n; ++i){
+        x_min = std::min(x_min, xy[2*i]); x_max = std::max(x_max, xy[2*i]);
+        y_min = std::min(y_min, xy[2*i+1]); y_max = std::max(y_max, xy[2*i+1]);
+    }
+    double scale = 65535/std::max(std::max(x_max-x_min, y_max-y_min), 1e-300);
+    std::vector< std::pair<uint64_t,uint32_t> > keyed(n);
+    for(std::size_t i=0; i<n; ++i){
+        keyed[i] = {hilbert_key((uint32_t)((xy[2*i]-x_min)*scale), (uint32_t)((xy[2*i+1]-y_min)*scale)), (uint32_t)i};
+    }
+    presort::radix_sort(keyed, [](const std::pair<uint64_t,uint32_t>& k){return k.first;});
+    for(std::size_t i=0; i<n; ++i){order[i] = keyed[i].second;}
+    return order;
+}
+inline std::vector< uint32_t > hilbert_order(const std::vector< double >& xy){return hilbert_order(xy.data(), xy.size()/2);}
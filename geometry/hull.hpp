@@ -0,0 +1,259 @@
+// convex hull, Chan's algorithm (graham scan on groups of m points, then a gift wrap that only looks at each group's extremal point)
+// plain coordinates, no drawing: the convex_hull demo draws the result
+// coordinates are screen coordinates (y grows downwards)
+// templated on the coordinate type (see coords.hpp): float by default, integers give an exact hull
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "coords.hpp"
+#include "presort.hpp"
+#include "progress.hpp"
+#include "trace.hpp"
+
+namespace convex{
+
+template< typename T, typename Tol = coords::DefaultTolerance< T > >
+struct BasicPoint{
+    typedef coords::Kernel< T, Tol > K;
+    T x;
+    T y;
+    bool operator< (const BasicPoint& rhs) const{
+        if(!K::close(x, rhs.x)){
+            return x < rhs.x;
+        }else{
+            return y > rhs.y;
+        }
+    }
+};
+
+typedef BasicPoint< float > Point;
+
+// is a->b->c a right turn?
+template< typename P >
+bool right_turn(const P a, const P b, const P c){
+    typedef typename P::K K;
+    TRACE_COUNT("hull/right_turn");
+    /*
+        cross>0 if left turn a->b->c
+        cross<0 if right turn a->b->c
+        cross=0 if collinear
+    */
+    auto cross = K::cross(a.x, a.y, b.x, b.y, c.x, c.y);
+    cross *= -1; // because sfml y-axis (computer graphics in general) is upside down
+    if(!K::zero(cross)){
+        return cross<0;
+    }else{
+        auto dot = K::dot(a.x, a.y, b.x, b.y, c.x, c.y);
+        return dot<0 && !K::zero(dot);
+        // for collinear a-b-c right turn iff a->b->c is 180 deg (left turn if 0 deg)
+        // a->a->c is a left turn (helps in function extremal_point when q is a point in chain)
+    }
+}
+
+// returns sorted anti-clockwise
+template< typename P >
+std::vector< P > grahamScan(typename std::vector< P >::const_iterator begin, typename std::vector< P >::const_iterator end){
+    int n = end-begin;
+    if(n<3){
+        return std::vector< P >(begin, end);
+    }
+
+    std::vector< P > fhull;    // 'forward' hull
+    auto it = begin;
+    fhull.push_back(*it); ++it;
+    fhull.push_back(*it); ++it;
+    for(; it != end; ++it){
+        fhull.push_back(*it);
+        while(fhull.size()>2 && !right_turn(fhull.end()[-3], fhull.end()[-2], fhull.end()[-1])){
+            fhull.erase(fhull.end()-2);
+        }
+    }
+
+    auto rbegin = std::make_reverse_iterator(end);
+    auto rend = std::make_reverse_iterator(begin);
+
+    std::vector< P > rhull; // other half ('reverse' hull)
+    auto rit = rbegin;
+    rhull.push_back(*rit); ++rit;
+    rhull.push_back(*rit); ++rit;
+    for(; rit != rend; ++rit){
+        rhull.push_back(*rit);
+        while(rhull.size()>2 && !right_turn(rhull.end()[-3], rhull.end()[-2], rhull.end()[-1])){
+            rhull.erase(rhull.end()-2);
+        }
+    }
+
+    fhull.insert(fhull.end(), rhull.begin()+1, rhull.end()-1);
+    return fhull;
+}
+
+// returns p such that entire chain is to the right of q->p
+// if q is a part of chain returns prev(q) or earliest such point in the chain if q, prev_q, prev_prev_q are collinear etc
+// binary search, O(log(chain.size))
+template< typename P >
+P extremal_point(const std::vector< P >& chain, P q){
+    TRACE_COUNT("hull/extremal_point");
+    auto first = chain.begin();
+    auto last = chain.end();
+
+    while((first+1)!=last){
+        if(first+2 == last){    // length 2 chain
+            return right_turn(q, *first, *(first+1)) ? *first : *(first+1);
+        }
+        // now (last-first) is atleast 3
+
+        bool is_prev_right = right_turn(q, *first, *(last-1));
+        bool is_next_right = right_turn(q, *first, *(first+1));
+        if(is_prev_right && is_next_right){
+            return *first;
+        }
+        // which part is 'first' in
+        bool in_farside = (is_prev_right && !is_next_right);
+        bool in_nearside = (!is_prev_right && is_next_right);
+        // bool at_opposite_extreme = (!is_prev_right && !is_next_right);
+
+        auto middle = first + (last-first)/2;
+        is_prev_right = right_turn(q, *middle, *(middle-1));
+        is_next_right = right_turn(q, *middle, *(middle+1));
+        if(is_prev_right && is_next_right){
+            return *middle;
+        }
+        if(is_prev_right && !is_next_right){    // middle in farside, check if first was also in farside etc
+            if(!in_farside || right_turn(q, *middle, *first)){
+                first = middle+1;
+            }else{
+                last = middle;
+            }
+        }else
+        if(!is_prev_right && is_next_right){    // middle in nearside, check if first was also in nearside etc
+            if(!in_nearside || right_turn(q, *middle, *first)){
+                last = middle;
+            }else{
+                first = middle+1;
+            }
+        }else{      // middle is at the other extremal point
+            if(in_farside){
+                last = middle;
+            }else
+            if(in_nearside){
+                first = middle+1;
+            }
+        }
+    }
+    return *first;
+}
+
+// equality check
+template< typename P >
+bool close(P a, P b){
+    return P::K::close(a.x, b.x) && P::K::close(a.y, b.y);
+}
+
+// append q from Q to result such that [result[-2] -- result[-1] -- q] angle is maximum, linear scan
+// (an angle, not a predicate: compared in double whatever the coordinates)
+template< typename P >
+void add_max_angle_point(std::vector< P >& result, std::vector< P >& Q){
+    double x1,y1,x2,y2;
+    x2 = result.back().x;
+    y2 = result.back().y;
+    bool degenerate_case = (result.size()==1);
+    if(degenerate_case){
+        x1 = x2;
+        y1 = std::numeric_limits< double >::max();   // not actually used for computation/comparison, also should it be -INF because sfml y-axis is upside down?
+    }else{
+        x1 = result.end()[-2].x;
+        y1 = result.end()[-2].y;
+    }
+    P* maxsofar = nullptr;
+    double maxval = -std::numeric_limits< double >::max();
+    for(auto& q : Q){
+        double qx = q.x, qy = q.y;
+        double tmp = degenerate_case ? -(y2-qy) : (qx-x2)*(x2-x1) + (qy-y2)*(y2-y1);
+        tmp /= std::sqrt((qx-x2)*(qx-x2) + (qy-y2)*(qy-y2));
+        if(tmp > maxval){
+            maxval = tmp;
+            maxsofar = &q;
+        }
+    }
+    if(maxsofar){result.push_back(*maxsofar);}
+}
+
+// main algorithm
+// expects sorted points
+// returns empty vector on failure
+template< typename P >
+std::vector< P > chan_algo(const std::vector< P >& points, int m){
+    TRACE_COUNT("hull/chan_attempts");
+    int n = points.size();
+    std::vector< std::vector< P > > hulls;
+    {
+        TRACE_SCOPE("hull/graham");
+        for(int i=0, j=0; j<n ; ++i){
+            j += m;
+            if(j>n){j = n;}
+            hulls.push_back(grahamScan< P >(points.begin()+i*m, points.begin()+j));
+            if(!progress::report(i)){return std::vector< P >{};}
+        }
+    }
+    TRACE_SCOPE("hull/wrap");
+
+    auto& rightmost = points.back();
+    std::vector< P > result{rightmost};
+
+    for(int j = 0; j<m; ++j){
+        if(!progress::report(j)){return std::vector< P >{};}
+        std::vector< P > Q;
+        for(auto& hull : hulls){
+            auto p = extremal_point(hull, result.back());
+
+            // p must not be the same as the second last or last element in result
+            if(!close(result.end()[-1], p) && ((result.size()==1) || (!close(result.end()[-2], p)))){
+                Q.push_back(p);
+            }
+        }
+        add_max_angle_point(result, Q); // result.push_back(max_angle_point(result[-1], result[-2], Q))
+        if(close(result.back(), result.front())){return result;}
+    }
+    return std::vector< P >{};
+}
+
+// the hull of points[order[0]], points[order[1]], ... which have to be in hull order (by x, for equal x larger y first), as
+// presort::sort_points(..., PointOrder::by_x, ...) gives them, as a closed loop (the first point is repeated at the end),
+// empty if there are no points (or if it was stopped early, see progress.hpp)
+// guesses m = 2^(2^t) for t = 0,1,... until chan_algo succeeds (m = n always does, so that's the last guess)
+template< typename T, typename Tol >
+std::vector< BasicPoint< T, Tol > > convex_hull(const std::vector< BasicPoint< T, Tol > >& points, const std::vector< uint32_t >& order){
+    std::vector< BasicPoint< T, Tol > > sorted(order.size());
+    for(std::size_t i=0; i<order.size(); ++i){sorted[i] = points[order[i]];}
+    int n = sorted.size();
+    for(int t = 0; n > 0; ++t){
+        int m = t < 5 ? 1<<(1<<t) : n; // 2^(2^t)
+        if(m>n){m = n;}
+        auto result = chan_algo(sorted, m);
+        if(!result.empty() || m == n || progress::stopped()){
+            return result;
+        }
+    }
+    return std::vector< BasicPoint< T, Tol > >{};
+}
+
+// the hull of any set of points, as above (exact duplicates are dropped first, they can't change it)
+template< typename T, typename Tol >
+std::vector< BasicPoint< T, Tol > > convex_hull(const std::vector< BasicPoint< T, Tol > >& points){
+    static_assert(sizeof(BasicPoint< T, Tol >) == 2*sizeof(T), "points are read as x0 y0 x1 y1 ...");
+    if(points.empty()){return std::vector< BasicPoint< T, Tol > >{};}
+    std::vector< uint32_t > order;
+    {
+        TRACE_SCOPE("hull/sort");
+        order = presort::sort_points(&points[0].x, &points[0].y, 2, points.size(), presort::PointOrder::by_x, true);
+    }
+    return convex_hull(points, order);
+}
+
+}
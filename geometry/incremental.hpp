@@ -0,0 +1,420 @@
+// incremental Delaunay triangulation (Bowyer-Watson) with jump-and-walk point location
+// independent of the sweep in fortune.hpp: no sfml, no globals, sites are addressed by integer handles
+// (handles are stable, the n-th distinct inserted site is handle n-1 forever)
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "hilbert.hpp"
+
+class Triangulation{
+    public:
+        struct Site{
+            double x;
+            double y;
+        };
+        struct Triangle{
+            int v[3];   // vertex ids, counter-clockwise in the sense of orient() > 0
+            int n[3];   // n[i] is the neighbouring triangle across the edge opposite to v[i], -1 if none
+            bool alive;
+        };
+
+        static constexpr int SUPER = 3;         // vertex ids 0,1,2 are the super-triangle, site handle h is vertex id h+SUPER
+        static constexpr double eps = 1e-5;     // same tolerance as the sweep, sites closer than this are duplicates
+
+        std::vector< Site > sites;              // indexed by vertex id
+        std::vector< Triangle > tris;
+
+    private:
+        std::vector< int > vtri;                // vertex id -> some alive triangle incident to it
+        std::vector< int > free_tris;           // dead slots in tris, reused by later insertions
+        std::vector< unsigned > mark;           // per triangle, == epoch if in the current cavity, == epoch+1 if rejected
+        unsigned epoch = 0;
+        int last = 0;                           // most recently created triangle, where the next walk starts from
+        bool ordered = false;                   // sites come in spatially coherent order, start every walk from last
+        unsigned long long seed = 88172645463325252ull;
+
+        // scratch buffers, kept around so an insertion doesn't allocate once things have warmed up
+        std::vector< int > cavity;
+        struct BoundaryEdge{int a, b, outside;};    // edge a->b of the cavity boundary (ccw around p) and the triangle beyond it
+        std::vector< BoundaryEdge > boundary;
+        std::vector< int > fresh;
+
+        unsigned next_random(){
+            // xorshift, the walk only needs something cheap that doesn't repeat a pattern
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+            return (unsigned)seed;
+        }
+
+        double orient(int a, int b, const Site& c) const {
+            // >0 if a->b->c turns counter-clockwise (in the y-up sense, it is clockwise on screen but it doesn't matter as long as it's consistent)
+            const Site& p = sites[a];
+            const Site& q = sites[b];
+            return (q.x-p.x)*(c.y-p.y) - (q.y-p.y)*(c.x-p.x);
+        }
+
+        bool in_circumcircle(int t, const Site& p) const {
+            const Triangle& T = tris[t];
+            int supers = (T.v[0] < SUPER) + (T.v[1] < SUPER) + (T.v[2] < SUPER);
+            if(supers > 0){
+                // the super-triangle's vertices stand for points at infinity, so these circles are taken as the limit they
+                // tend to, a half-plane (with big but finite circles, sites just outside a nearly straight hull would
+                // stay connected to the super-triangle)
+                if(supers == 3){return true;}
+                int k = 0;
+                if(supers == 1){
+                    while(T.v[k] >= SUPER){++k;}
+                    // real edge a->b, the super vertex is on its left: inside is strictly left of the line, or on the edge itself
+                    const Site& a = sites[T.v[(k+1)%3]];
+                    const Site& b = sites[T.v[(k+2)%3]];
+                    double o = orient(T.v[(k+1)%3], T.v[(k+2)%3], p);
+                    if(o != 0){return o > 0;}
+                    double dot = (p.x-a.x)*(b.x-a.x) + (p.y-a.y)*(b.y-a.y);
+                    return dot > 0 && dot < (b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y);
+                }
+                // one real vertex v, inside is the open half-plane beyond the line through v parallel to the super edge
+                while(T.v[k] < SUPER){++k;}
+                const Site& v = sites[T.v[k]];
+                const Site& s1 = sites[T.v[(k+1)%3]];
+                const Site& s2 = sites[T.v[(k+2)%3]];
+                double dx = s2.x-s1.x, dy = s2.y-s1.y;
+                return dx*(p.y-v.y) - dy*(p.x-v.x) < 0;   // v is left of s1->s2, so the side of the super edge is the right
+            }
+            double adx = sites[T.v[0]].x-p.x, ady = sites[T.v[0]].y-p.y;
+            double bdx = sites[T.v[1]].x-p.x, bdy = sites[T.v[1]].y-p.y;
+            double cdx = sites[T.v[2]].x-p.x, cdy = sites[T.v[2]].y-p.y;
+            double det = (adx*adx + ady*ady)*(bdx*cdy - cdx*bdy)
+                       + (bdx*bdx + bdy*bdy)*(cdx*ady - adx*cdy)
+                       + (cdx*cdx + cdy*cdy)*(adx*bdy - bdx*ady);
+            return det > 0;
+        }
+
+        int new_triangle(int a, int b, int c){
+            int t;
+            if(!free_tris.empty()){
+                t = free_tris.back(); free_tris.pop_back();
+            }else{
+                t = tris.size();
+                tris.push_back(Triangle());
+                mark.push_back(0);
+            }
+            Triangle& T = tris[t];
+            T.v[0] = a; T.v[1] = b; T.v[2] = c;
+            T.n[0] = T.n[1] = T.n[2] = -1;
+            T.alive = true;
+            return t;
+        }
+
+        // starting triangle for the walk: closest of ~n^(1/3) randomly sampled sites and the last insertion
+        int jump(const Site& p){
+            int n = sites.size() - SUPER;
+            if(n < 8 || ordered){return last;}
+            const Site& l = sites[tris[last].v[0]];
+            double best = (l.x-p.x)*(l.x-p.x) + (l.y-p.y)*(l.y-p.y);
+            int start = last;
+            int samples = (int)std::cbrt((double)n);
+            for(int i=0; i<samples; ++i){
+                int v = SUPER + next_random()%n;
+                double d = (sites[v].x-p.x)*(sites[v].x-p.x) + (sites[v].y-p.y)*(sites[v].y-p.y);
+                if(d < best){best = d; start = vtri[v];}
+            }
+            return start;
+        }
+
+    public:
+        // sites are expected to be (roughly) inside the given box, the super-triangle is made big enough to hold anything
+        // within a few thousand box-widths of it so that its vertices don't visibly bend the hull edges
+        Triangulation(double x_min = 0, double y_min = 0, double x_max = 1000, double y_max = 1000){
+            double cx = (x_min+x_max)/2, cy = (y_min+y_max)/2;
+            double M = 1e4*std::max(std::max(x_max-x_min, y_max-y_min), 1.0);
+            sites.push_back(Site{cx-3*M, cy-3*M});
+            sites.push_back(Site{cx+3*M, cy-3*M});
+            sites.push_back(Site{cx, cy+3*M});
+            vtri.assign(SUPER, 0);
+            new_triangle(0, 1, 2);
+            last = 0;
+        }
+
+        // drop all sites but keep every buffer's capacity
+        void clear(){
+            sites.resize(SUPER);
+            vtri.assign(SUPER, 0);
+            tris.clear();
+            mark.clear();
+            free_tris.clear();
+            epoch = 0;
+            new_triangle(0, 1, 2);
+            last = 0;
+        }
+
+        void reserve(int n){
+            sites.reserve(n+SUPER);
+            vtri.reserve(n+SUPER);
+            tris.reserve(2*n+1);
+            mark.reserve(2*n+1);
+        }
+
+        int size() const {return sites.size() - SUPER;}
+        const Site& site(int handle) const {return sites[handle+SUPER];}
+        bool is_super(int v) const {return v < SUPER;}
+        int incident_triangle(int handle) const {return vtri[handle+SUPER];}
+
+        // triangle containing p (on its boundary counts), -1 if p is outside the super-triangle
+        int locate(const Site& p){
+            int t = jump(p);
+            while(true){
+                const Triangle& T = tris[t];
+                int r = next_random()%3;    // randomised edge order, so the walk can't cycle
+                int next = t;
+                for(int k=0; k<3; ++k){
+                    int i = (r+k)%3;
+                    if(orient(T.v[(i+1)%3], T.v[(i+2)%3], p) < 0){
+                        next = T.n[i];
+                        break;
+                    }
+                }
+                if(next == t){return t;}
+                if(next < 0){return -1;}
+                t = next;
+            }
+        }
+
+        // returns the handle of the new site (or of the existing one if p duplicates it), -1 if p is out of range
+        int insert(double x, double y){
+            Site p{x, y};
+            int t = locate(p);
+            if(t < 0){return -1;}
+            int id = sites.size();
+
+            // grow the cavity: every triangle whose circumcircle contains p, it is connected and contains t
+            epoch += 2;
+            cavity.clear();
+            cavity.push_back(t);
+            mark[t] = epoch;
+            for(std::size_t k=0; k<cavity.size(); ++k){
+                const Triangle& T = tris[cavity[k]];
+                for(int i=0; i<3; ++i){
+                    int nb = T.n[i];
+                    if(nb < 0 || mark[nb] == epoch || mark[nb] == epoch+1){continue;}
+                    if(in_circumcircle(nb, p)){
+                        mark[nb] = epoch;
+                        cavity.push_back(nb);
+                    }else{
+                        mark[nb] = epoch+1;
+                    }
+                }
+            }
+            boundary.clear();
+            for(int c : cavity){
+                const Triangle& T = tris[c];
+                for(int i=0; i<3; ++i){
+                    int nb = T.n[i];
+                    if(nb < 0 || mark[nb] != epoch){boundary.push_back(BoundaryEdge{T.v[(i+1)%3], T.v[(i+2)%3], nb});}
+                }
+            }
+            // a site closer than eps would be a neighbour of p (the nearest site always is), so it's on the cavity boundary,
+            // which may reach past the triangle p is in. nothing has changed yet, so p can still be dropped for it
+            int dup = -1;
+            double dup_d = 0;
+            for(auto& e : boundary){
+                int v = e.a;
+                if(v < SUPER || std::abs(sites[v].x-x) >= eps || std::abs(sites[v].y-y) >= eps){continue;}
+                double d = (sites[v].x-x)*(sites[v].x-x) + (sites[v].y-y)*(sites[v].y-y);
+                if(dup < 0 || d < dup_d){dup = v; dup_d = d;}
+            }
+            if(dup >= 0){return dup - SUPER;}
+            sites.push_back(p);
+            vtri.push_back(t);
+
+            for(int c : cavity){
+                tris[c].alive = false;
+                free_tris.push_back(c);
+            }
+
+            // re-triangulate the cavity as a fan around p, one triangle per boundary edge (new triangles may reuse cavity slots)
+            fresh.clear();
+            for(auto& e : boundary){
+                int nt = new_triangle(id, e.a, e.b);
+                fresh.push_back(nt);
+                tris[nt].n[0] = e.outside;
+                if(e.outside >= 0){
+                    // fix the back-pointer of the outside triangle, the shared edge is opposite its vertex that isn't a or b
+                    Triangle& O = tris[e.outside];
+                    for(int j=0; j<3; ++j){
+                        if(O.v[j] != e.a && O.v[j] != e.b){O.n[j] = nt;}
+                    }
+                }
+                vtri[e.a] = nt;
+                vtri[e.b] = nt;
+            }
+            // neighbours inside the fan: the triangle (id, a, b) meets (id, b, c) across (id, b), and (id, z, a) across (id, a)
+            // the boundary is small (6 edges on average) so the quadratic matching is cheaper than a hash map
+            for(std::size_t k=0; k<boundary.size(); ++k){
+                for(std::size_t j=0; j<boundary.size(); ++j){
+                    if(boundary[j].a == boundary[k].b){tris[fresh[k]].n[1] = fresh[j];}
+                    if(boundary[j].b == boundary[k].a){tris[fresh[k]].n[2] = fresh[j];}
+                }
+            }
+            vtri[id] = fresh[0];
+            last = fresh[0];
+            return id - SUPER;
+        }
+
+        // what the last insert() changed, if it added a site (a duplicate changes nothing, and then these mean nothing):
+        // the triangles it removed (the new ones may have taken over some of their slots) and the ones it created, the new
+        // site's star. each created one meets a triangle that was there before across its edge n[0], those are the only
+        // other triangles whose neighbours changed
+        const std::vector< int >& removed() const {return cavity;}
+        const std::vector< int >& created() const {return fresh;}
+
+        // bulk insertion of the points in xy (x0,y0,x1,y1,...) along a Hilbert curve (see hilbert.hpp): each site is a
+        // neighbour of the one before it, so every walk just starts from the previous insertion and is a step or two long
+        // handles[i] is the handle point i got (handles are given out in curve order, not in the order of xy)
+        void insert_all(const std::vector< double >& xy, std::vector< int >& handles){
+            insert_all(xy.data(), xy.size()/2, handles);
+        }
+        // same, for the n points at xy wherever they are (a mapped file, say)
+        void insert_all(const double* xy, std::size_t n, std::vector< int >& handles){
+            insert_all(xy, n, hilbert_order(xy, n), handles);
+        }
+        // same, in a given order (order[k] is the index of the k-th point to insert), for when the order is reused
+        void insert_all(const std::vector< double >& xy, const std::vector< uint32_t >& order, std::vector< int >& handles){
+            insert_all(xy.data(), xy.size()/2, order, handles);
+        }
+        void insert_all(const double* xy, std::size_t n, const std::vector< uint32_t >& order, std::vector< int >& handles){
+            handles.resize(n);
+            reserve(size() + n);
+            ordered = true;
+            for(uint32_t i : order){handles[i] = insert(xy[2*i], xy[2*i+1]);}
+            ordered = false;
+        }
+
+        Site circumcenter(int t) const {
+            const Triangle& T = tris[t];
+            const Site& a = sites[T.v[0]];
+            double bx = sites[T.v[1]].x-a.x, by = sites[T.v[1]].y-a.y;
+            double cx = sites[T.v[2]].x-a.x, cy = sites[T.v[2]].y-a.y;
+            double d = 2*(bx*cy - by*cx);
+            double b2 = bx*bx + by*by, c2 = cx*cx + cy*cy;
+            return Site{a.x + (cy*b2 - by*c2)/d, a.y + (bx*c2 - cx*b2)/d};
+        }
+
+        // triangles around a site, counter-clockwise, appended to out
+        void star(int handle, std::vector< int >& out) const {
+            int v = handle+SUPER;
+            int t = vtri[v];
+            do{
+                out.push_back(t);
+                const Triangle& T = tris[t];
+                int i = (T.v[0]==v) ? 0 : (T.v[1]==v) ? 1 : 2;
+                t = T.n[(i+1)%3];   // across the edge (v, v[i+2]), the next triangle counter-clockwise around v
+            }while(t != vtri[v]);
+        }
+
+        // Voronoi cell of a site: the circumcenters of the triangles around it, as a convex polygon
+        // (cells of hull sites reach out to the far away circumcenters of the triangles touching the super-triangle, clip them)
+        std::vector< Site > cell(int handle) const {
+            std::vector< Site > poly;
+            std::vector< int > around;
+            cell(handle, poly, around);
+            return poly;
+        }
+        // same, into caller owned buffers (around is scratch space) so that a loop over all cells doesn't allocate
+        void cell(int handle, std::vector< Site >& poly, std::vector< int >& around) const {
+            around.clear();
+            star(handle, around);
+            poly.clear();
+            for(int t : around){poly.push_back(circumcenter(t));}
+        }
+
+        // every Delaunay edge once, as a pair of site handles (edges to the super-triangle are left out)
+        std::vector< std::pair<int,int> > delaunay_edges() const {
+            std::vector< std::pair<int,int> > edges;
+            for(int t=0; t<(int)tris.size(); ++t){
+                const Triangle& T = tris[t];
+                if(!T.alive){continue;}
+                for(int i=0; i<3; ++i){
+                    int a = T.v[(i+1)%3], b = T.v[(i+2)%3];
+                    if(a < SUPER || b < SUPER){continue;}
+                    if(T.n[i] < 0 || T.n[i] > t){edges.push_back({a-SUPER, b-SUPER});}
+                }
+            }
+            return edges;
+        }
+
+        // dual of delaunay_edges(): the segment between the circumcenters of the two triangles sharing a Delaunay edge
+        // on the hull one of them touches the super-triangle and its circumcenter is far away, which draws as a ray
+        std::vector< std::pair<Site,Site> > voronoi_edges() const {
+            std::vector< std::pair<Site,Site> > edges;
+            for(int t=0; t<(int)tris.size(); ++t){
+                const Triangle& T = tris[t];
+                if(!T.alive){continue;}
+                for(int i=0; i<3; ++i){
+                    int a = T.v[(i+1)%3], b = T.v[(i+2)%3];
+                    if(a < SUPER || b < SUPER || T.n[i] < t){continue;}
+                    edges.push_back({circumcenter(t), circumcenter(T.n[i])});
+                }
+            }
+            return edges;
+        }
+};
+
+// the triangulation of the n points xy (x0 y0 x1 y1 ...), handles[i] is the site of point i (duplicates share one)
+inline void triangulate(const double* xy, std::size_t n, Triangulation& tr, std::vector< int >& handles){
+    double x_min = 0, y_min = 0, x_max = 1, y_max = 1;
+    for(std::size_t i=0; i<n; ++i){
+        if(i == 0 || xy[2*i] < x_min){x_min = xy[2*i];}
+        if(i == 0 || xy[2*i] > x_max){x_max = xy[2*i];}
+        if(i == 0 || xy[2*i+1] < y_min){y_min = xy[2*i+1];}
+        if(i == 0 || xy[2*i+1] > y_max){y_max = xy[2*i+1];}
+    }
+    tr = Triangulation(x_min, y_min, x_max, y_max);
+    tr.insert_all(xy, n, handles);
+}
+inline void triangulate(const std::vector< double >& xy, Triangulation& tr, std::vector< int >& handles){
+    triangulate(xy.data(), xy.size()/2, tr, handles);
+}
+
+// per site handle, the first point that landed on it
+inline std::vector< int > first_point(const std::vector< int >& handles, int sites){
+    std::vector< int > first(sites, -1);
+    for(int i=(int)handles.size()-1; i>=0; --i){
+        if(handles[i] >= 0){first[handles[i]] = i;}
+    }
+    return first;
+}
+
+// Sutherland-Hodgman clipping of a convex polygon to the box [x0,x1]x[y0,y1] in place, empty if they don't overlap (scratch is just space)
+inline void clip_to_box(std::vector< Triangulation::Site >& poly, std::vector< Triangulation::Site >& scratch, double x0, double y0, double x1, double y1){
+    typedef Triangulation::Site Site;
+    // side k keeps points with sign*coord <= bound
+    for(int k=0; k<4; ++k){
+        bool use_x = (k < 2);
+        double sign = (k%2 == 0) ? -1 : 1;
+        double bound = (k==0) ? -x0 : (k==1) ? x1 : (k==2) ? -y0 : y1;
+        auto value = [&](const Site& p){return sign*(use_x ? p.x : p.y) - bound;}; // <= 0 is inside
+        scratch.clear();
+        for(std::size_t i=0; i<poly.size(); ++i){
+            const Site& p = poly[i];
+            const Site& q = poly[(i+1)%poly.size()];
+            double vp = value(p), vq = value(q);
+            if(vp <= 0){scratch.push_back(p);}
+            if((vp < 0 && vq > 0) || (vp > 0 && vq < 0)){
+                double t = vp/(vp-vq);
+                scratch.push_back(Site{p.x + t*(q.x-p.x), p.y + t*(q.y-p.y)});
+            }
+        }
+        poly.swap(scratch);
+        if(poly.empty()){break;}
+    }
+}
+
+inline std::vector< Triangulation::Site > clip_to_box(std::vector< Triangulation::Site > poly, double x0, double y0, double x1, double y1){
+    std::vector< Triangulation::Site > scratch;
+    clip_to_box(poly, scratch, x0, y0, x1, y1);
+    return poly;
+}
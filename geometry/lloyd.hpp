@@ -0,0 +1,101 @@
+// Lloyd relaxation (centroidal Voronoi tessellation): move every site to the centroid of its Voronoi cell clipped to a box, repeat
+// one Triangulation is kept for the whole run and cleared (not freed) between iterations, so after the first iteration
+// nothing is allocated any more: triangle and site arrays, the insertion scratch buffers and the per-thread centroid buffers
+// are all reused. sites are inserted in the same spatially coherent order every time (they only move a little per
+// iteration), so each insertion walk starts right next to where it ends and the rebuild is close to linear
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include "incremental.hpp"
+#include "hilbert.hpp"
+
+class Lloyd{
+        Triangulation tr;
+        std::vector< double > xy;       // current sites (x0,y0,x1,y1,...)
+        std::vector< uint32_t > order;  // insertion order, along a Hilbert curve through the starting sites
+        std::vector< int > handle;      // site -> its handle in tr for the current iteration (duplicates share one)
+        std::vector< Triangulation::Site > centroid;   // per handle
+        double x0, y0, x1, y1;
+        int threads;
+
+        struct Scratch{
+            std::vector< Triangulation::Site > poly, clip;
+            std::vector< int > around;
+        };
+        std::vector< Scratch > scratch;
+
+        // centroid of the cell of handle h clipped to the box (the site itself if the clipped cell is degenerate)
+        Triangulation::Site cell_centroid(int h, Scratch& s) const {
+            tr.cell(h, s.poly, s.around);
+            clip_to_box(s.poly, s.clip, x0, y0, x1, y1);
+            double A = 0, cx = 0, cy = 0;
+            for(std::size_t i=0; i<s.poly.size(); ++i){
+                auto& p = s.poly[i];
+                auto& q = s.poly[(i+1)%s.poly.size()];
+                double c = p.x*q.y - q.x*p.y;
+                A += c;
+                cx += (p.x+q.x)*c;
+                cy += (p.y+q.y)*c;
+            }
+            if(std::abs(A) < 1e-12){return tr.site(h);}
+            return Triangulation::Site{cx/(3*A), cy/(3*A)};
+        }
+
+    public:
+        // sites are clipped to (and stay inside) the box [x0,x1]x[y0,y1], threads = 0 means one per core
+        Lloyd(const std::vector< double >& sites, double x0, double y0, double x1, double y1, int threads = 0)
+            : tr(x0, y0, x1, y1), xy(sites), x0(x0), y0(y0), x1(x1), y1(y1){
+            if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+            this->threads = threads;
+            scratch.resize(threads);
+            int n = xy.size()/2;
+            tr.reserve(n);
+            handle.resize(n);
+            centroid.reserve(n);
+            order = hilbert_order(xy);
+        }
+
+        const std::vector< double >& sites() const {return xy;}
+        const Triangulation& triangulation() const {return tr;}
+
+        // one iteration, returns how far the farthest site moved
+        double step(){
+            int n = xy.size()/2;
+            tr.clear();
+            tr.insert_all(xy, order, handle);
+
+            int m = tr.size();
+            centroid.resize(m);
+            int T = std::min(threads, std::max(1, m/256));
+            auto run = [&](int t){
+                for(int h = (long long)m*t/T; h < (long long)m*(t+1)/T; ++h){centroid[h] = cell_centroid(h, scratch[t]);}
+            };
+            std::vector< std::thread > pool;
+            for(int t=1; t<T; ++t){pool.emplace_back(run, t);}
+            run(0);
+            for(auto& th : pool){th.join();}
+
+            double moved = 0;
+            for(int i=0; i<n; ++i){
+                if(handle[i] < 0){continue;}
+                auto& c = centroid[handle[i]];
+                moved = std::max(moved, std::hypot(c.x-xy[2*i], c.y-xy[2*i+1]));
+                xy[2*i] = c.x;
+                xy[2*i+1] = c.y;
+            }
+            return moved;
+        }
+
+        // at most iterations steps, stops early once no site moves more than tolerance, returns the number of steps taken
+        int run(int iterations, double tolerance = 0){
+            for(int i=1; i<=iterations; ++i){
+                if(step() <= tolerance){return i;}
+            }
+            return iterations;
+        }
+};
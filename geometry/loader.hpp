@@ -0,0 +1,124 @@
+// fast loading of point sets into a plain coordinate array (x0,y0,x1,y1,...), nothing drawable is created here
+// two input formats, told apart by the first 8 bytes:
+//  text:   the testcase.txt format, a count N followed by N whitespace separated "x y" pairs
+//  binary: the 8 byte magic "GEOPTS01", a uint64 count N, then N (x,y) pairs of native (little-endian) doubles
+// files are memory mapped, text is parsed in place with std::from_chars and binary is usable without any parsing at all
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char POINTS_MAGIC[8] = {'G','E','O','P','T','S','0','1'};
+
+// read-only view of a whole file, mmap'd when it is a regular file, otherwise (pipes, terminals) read into a buffer
+class MappedFile{
+        void* map = MAP_FAILED;
+        std::vector< char > buffer;
+
+        void open_fd(int fd){
+            struct stat st;
+            if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+                map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(map != MAP_FAILED){
+                    madvise(map, st.st_size, MADV_SEQUENTIAL);
+                    data = (const char*)map;
+                    size = st.st_size;
+                    ok = true;
+                    return;
+                }
+            }
+            char chunk[1<<16];
+            ssize_t got;
+            while((got = read(fd, chunk, sizeof(chunk))) > 0){buffer.insert(buffer.end(), chunk, chunk+got);}
+            data = buffer.data();
+            size = buffer.size();
+            ok = (got == 0);
+        }
+    public:
+        const char* data = nullptr;
+        std::size_t size = 0;
+        bool ok = false;
+
+        MappedFile(int fd){open_fd(fd);}
+        MappedFile(const char* path){
+            int fd = open(path, O_RDONLY);
+            if(fd < 0){return;}
+            open_fd(fd);    // the mapping outlives the descriptor
+            close(fd);
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile(){
+            if(map != MAP_FAILED){munmap(map, size);}
+        }
+};
+
+inline bool is_binary_points(const MappedFile& f){
+    return f.size >= 16 && memcmp(f.data, POINTS_MAGIC, 8) == 0;
+}
+
+// zero-copy access to the coordinates of a binary file (x0,y0,x1,y1,...), nullptr if it isn't one or is truncated
+// (mmap'd data is page aligned, so the doubles after the 16 byte header are aligned too)
+inline const double* binary_points(const MappedFile& f, std::size_t& n){
+    if(!is_binary_points(f)){return nullptr;}
+    uint64_t count;
+    memcpy(&count, f.data+8, 8);
+    if((f.size-16)/16 < count){return nullptr;}
+    n = count;
+    return (const double*)(f.data+16);
+}
+
+// parse the text format in [begin, end) into xy, false on malformed or short input
+inline bool parse_points_text(const char* begin, const char* end, std::vector< double >& xy){
+    auto skip = [&](){
+        while(begin != end && (*begin==' ' || *begin=='\n' || *begin=='\t' || *begin=='\r')){++begin;}
+    };
+    skip();
+    long long N;
+    auto res = std::from_chars(begin, end, N);
+    if(res.ec != std::errc() || N < 0){return false;}
+    begin = res.ptr;
+    if(N > (end-begin)/4 + 1){return false;}  // every coordinate takes at least 2 characters, don't trust a bogus count
+    std::size_t first = xy.size();
+    xy.resize(first + 2*N);
+    double* out = xy.data() + first;
+    for(long long i=0; i<2*N; ++i){
+        skip();
+        if(begin != end && *begin == '+'){++begin;}  // from_chars doesn't take a leading '+'
+        res = std::from_chars(begin, end, out[i]);
+        if(res.ec != std::errc()){xy.resize(first); return false;}
+        begin = res.ptr;
+    }
+    return true;
+}
+
+inline bool load_points(const MappedFile& f, std::vector< double >& xy){
+    if(!f.ok){return false;}
+    std::size_t n;
+    const double* p = binary_points(f, n);
+    if(p){
+        xy.insert(xy.end(), p, p+2*n);
+        return true;
+    }
+    return parse_points_text(f.data, f.data+f.size, xy);
+}
+inline bool load_points(int fd, std::vector< double >& xy){return load_points(MappedFile(fd), xy);}
+inline bool load_points(const char* path, std::vector< double >& xy){return load_points(MappedFile(path), xy);}
+
+inline bool save_points_binary(const char* path, const std::vector< double >& xy){
+    FILE* f = fopen(path, "wb");
+    if(!f){return false;}
+    uint64_t count = xy.size()/2;
+    bool ok = fwrite(POINTS_MAGIC, 1, 8, f) == 8
+           && fwrite(&count, 8, 1, f) == 1
+           && fwrite(xy.data(), sizeof(double), 2*count, f) == 2*count;
+    return (fclose(f) == 0) && ok;
+}
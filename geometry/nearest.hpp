@@ -0,0 +1,146 @@
+// nearest-site queries on a computed Delaunay triangulation
+// greedy walk on the Delaunay graph: from any site, step to a neighbour closer to the query until there is none,
+// the site you stop at is the nearest one (the Delaunay graph contains the nearest neighbour graph, so greedy can't get stuck)
+// walks start from a coarse bucket grid (or from the previous answer in a batch) so they are only a few steps long
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <cmath>
+
+#include "incremental.hpp"
+
+class NearestSite{
+        // Delaunay graph as flat arrays, neighbours of site i are adj[offset[i] .. offset[i+1])
+        std::vector< double > xs, ys;
+        std::vector< int > offset, adj;
+
+        // bucket grid over the bounding box of the sites, every cell holds some site close to it
+        double gx0 = 0, gy0 = 0, cell = 1;
+        int gw = 0, gh = 0;
+        std::vector< int > grid;
+
+        double dist2(int i, double x, double y) const {
+            return (xs[i]-x)*(xs[i]-x) + (ys[i]-y)*(ys[i]-y);
+        }
+
+        int cell_of(double x, double y) const {
+            int cx = std::min(std::max((int)((x-gx0)/cell), 0), gw-1);
+            int cy = std::min(std::max((int)((y-gy0)/cell), 0), gh-1);
+            return cy*gw + cx;
+        }
+
+        // z-order of the grid cell, sorting a batch by this keeps consecutive queries close to each other
+        uint64_t morton(double x, double y) const {
+            int c = cell_of(x, y);
+            uint64_t key = 0, cx = c%gw, cy = c/gw;
+            for(int b=0; b<32; ++b){
+                key |= ((cx>>b)&1) << (2*b);
+                key |= ((cy>>b)&1) << (2*b+1);
+            }
+            return key;
+        }
+
+    public:
+        NearestSite(const Triangulation& tr){
+            int n = tr.size();
+            xs.resize(n); ys.resize(n);
+            for(int i=0; i<n; ++i){
+                xs[i] = tr.site(i).x;
+                ys[i] = tr.site(i).y;
+            }
+            auto edges = tr.delaunay_edges();
+            offset.assign(n+1, 0);
+            for(auto& e : edges){++offset[e.first+1]; ++offset[e.second+1];}
+            for(int i=0; i<n; ++i){offset[i+1] += offset[i];}
+            adj.resize(offset[n]);
+            std::vector< int > fill(offset.begin(), offset.end()-1);
+            for(auto& e : edges){
+                adj[fill[e.first]++] = e.second;
+                adj[fill[e.second]++] = e.first;
+            }
+            if(n == 0){return;}
+
+            // about 2 sites per cell
+            double x_min = *std::min_element(xs.begin(), xs.end()), x_max = *std::max_element(xs.begin(), xs.end());
+            double y_min = *std::min_element(ys.begin(), ys.end()), y_max = *std::max_element(ys.begin(), ys.end());
+            double w = std::max(x_max-x_min, 1e-9), h = std::max(y_max-y_min, 1e-9);
+            cell = std::sqrt(2*w*h/n);
+            if(cell <= 0 || cell*4096 < std::max(w,h)){cell = std::max(w,h)/4096;}
+            gx0 = x_min; gy0 = y_min;
+            gw = std::max(1, (int)(w/cell)+1);
+            gh = std::max(1, (int)(h/cell)+1);
+            grid.assign((std::size_t)gw*gh, -1);
+            std::vector< int > frontier;
+            for(int i=0; i<n; ++i){
+                int c = cell_of(xs[i], ys[i]);
+                if(grid[c] < 0){grid[c] = i; frontier.push_back(c);}
+            }
+            // empty cells borrow a site from the closest filled cell (breadth first flood)
+            for(std::size_t k=0; k<frontier.size(); ++k){
+                int c = frontier[k], cx = c%gw, cy = c/gw;
+                int nbs[4][2] = {{cx-1,cy},{cx+1,cy},{cx,cy-1},{cx,cy+1}};
+                for(auto& nb : nbs){
+                    if(nb[0]<0 || nb[1]<0 || nb[0]>=gw || nb[1]>=gh){continue;}
+                    int d = nb[1]*gw + nb[0];
+                    if(grid[d] < 0){grid[d] = grid[c]; frontier.push_back(d);}
+                }
+            }
+        }
+
+        int size() const {return xs.size();}
+
+        // handle of the site closest to (x,y), -1 if there are no sites
+        // start is where the walk begins, any site works but a nearby one makes it short (defaults to the bucket grid)
+        int query(double x, double y, int start = -1) const {
+            if(xs.empty()){return -1;}
+            int v = start >= 0 ? start : grid[cell_of(x, y)];
+            double best = dist2(v, x, y);
+            while(true){
+                int next = v;
+                for(int k=offset[v]; k<offset[v+1]; ++k){
+                    double d = dist2(adj[k], x, y);
+                    if(d < best){best = d; next = adj[k];}
+                }
+                if(next == v){return v;}
+                v = next;
+            }
+        }
+
+        // answers[i] is the nearest site to queries[i]
+        // the batch is sorted along a z-order curve and split into contiguous runs, one per thread,
+        // each walk starts from the answer to the previous query of its run (or the grid, when the curve jumps)
+        std::vector< int > query_batch(const std::vector< std::pair<double,double> >& queries, int threads = 0) const {
+            int m = queries.size();
+            std::vector< int > answers(m, -1);
+            if(m == 0 || xs.empty()){return answers;}
+            if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+            threads = std::min(threads, std::max(1, m/1024));
+
+            std::vector< std::pair<uint64_t,int> > order(m);
+            for(int i=0; i<m; ++i){order[i] = {morton(queries[i].first, queries[i].second), i};}
+            std::sort(order.begin(), order.end());
+
+            auto run = [&](int begin, int end){
+                int prev = -1;
+                for(int k=begin; k<end; ++k){
+                    auto& q = queries[order[k].second];
+                    int start = grid[cell_of(q.first, q.second)];
+                    if(prev >= 0 && dist2(prev, q.first, q.second) < dist2(start, q.first, q.second)){start = prev;}
+                    prev = query(q.first, q.second, start);
+                    answers[order[k].second] = prev;
+                }
+            };
+            std::vector< std::thread > pool;
+            for(int t=1; t<threads; ++t){
+                pool.emplace_back(run, (long long)m*t/threads, (long long)m*(t+1)/threads);
+            }
+            run(0, m/threads);
+            for(auto& th : pool){th.join();}
+            return answers;
+        }
+};
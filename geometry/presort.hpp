@@ -0,0 +1,181 @@
+// the sorting the sweeps start with, done once up front: points into the order an engine takes them in
+// every coordinate maps to an unsigned integer that sorts the same way (ordered_bits), a point to one key packing its two
+// coordinates in the engine's order (point_key), and the keys go through a parallel LSD radix sort: BITS bits at a time from
+// the lowest up, each pass a stable counting sort split over threads (count per thread, prefix sums, scatter)
+// digits that are the same in every key are skipped, so narrow ranges (integer grids, hilbert keys) cost fewer passes
+// the order is exact, points closer than an engine's tolerance keep their exact order and the engine's own comparisons
+// still decide whether they are the same point. exact duplicates can be dropped on the way (dedup), the first one stays
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+#include "trace.hpp"
+
+namespace presort{
+
+// unsigned integers in the same order as the coordinates (-0 and +0 are the same)
+inline uint32_t ordered_bits(float v){
+    v += 0.0f;
+    uint32_t b;
+    memcpy(&b, &v, sizeof(b));
+    return (b & 0x80000000u) ? ~b : (b | 0x80000000u);
+}
+inline uint64_t ordered_bits(double v){
+    v += 0.0;
+    uint64_t b;
+    memcpy(&b, &v, sizeof(b));
+    return (b & 0x8000000000000000ull) ? ~b : (b | 0x8000000000000000ull);
+}
+inline uint32_t ordered_bits(int32_t v){return (uint32_t)v ^ 0x80000000u;}
+inline uint64_t ordered_bits(int64_t v){return (uint64_t)v ^ 0x8000000000000000ull;}
+
+// and back
+inline float float_from_bits(uint32_t k){
+    uint32_t b = (k & 0x80000000u) ? (k & 0x7fffffffu) : ~k;
+    float v;
+    memcpy(&v, &b, sizeof(v));
+    return v;
+}
+inline double double_from_bits(uint64_t k){
+    uint64_t b = (k & 0x8000000000000000ull) ? (k & 0x7fffffffffffffffull) : ~k;
+    double v;
+    memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+// the orders the engines take points in
+enum class PointOrder{
+    by_y,               // y ascending, then x ascending (segments.hpp's event queue)
+    by_y_descending,    // y descending, then x ascending (fortune.hpp's event queue)
+    by_x                // x ascending, then y descending (hull.hpp, chains.hpp)
+};
+
+// a point's key: two 32 bit coordinates in 64 bits, two 64 bit ones in 128
+template< typename T >
+using PointKey = typename std::conditional< sizeof(T) <= 4, uint64_t, unsigned __int128 >::type;
+
+template< typename T >
+inline PointKey< T > point_key(T x, T y, PointOrder order){
+    typedef PointKey< T > Key;
+    const int half = 4*sizeof(Key);
+    auto bx = ordered_bits(x);
+    auto by = ordered_bits(y);
+    typedef decltype(by) Bits;
+    switch(order){
+        case PointOrder::by_y: return (Key)by << half | bx;
+        case PointOrder::by_y_descending: return (Key)(Bits)~by << half | bx;
+        default: return (Key)bx << half | (Bits)~by;
+    }
+}
+
+// runs job(t) for t = 0 .. threads-1, t = 0 on the calling thread
+template< typename Job >
+inline void run_threads(int threads, Job job){
+    std::vector< std::thread > pool;
+    for(int t=1; t<threads; ++t){pool.emplace_back([&job, t](){job(t);});}
+    job(0);
+    for(auto& th : pool){th.join();}
+}
+
+const int BITS = 11;             // per pass, the counts of one digit (16 KB) stay in L1
+const int RADIX = 1 << BITS;
+
+// sorts items by key(item), an unsigned integer (up to 128 bits), stable, on up to threads threads (0 means one per core)
+template< typename Item, typename KeyOf >
+inline void radix_sort(std::vector< Item >& items, KeyOf key, int threads = 0){
+    typedef typename std::decay< decltype(key(items[0])) >::type Key;
+    std::size_t n = items.size();
+    if(n < RADIX){  // not worth RADIX buckets
+        std::stable_sort(items.begin(), items.end(), [&](const Item& a, const Item& b){return key(a) < key(b);});
+        return;
+    }
+    if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+    threads = std::max(1, (int)std::min< std::size_t >(threads, n/65536));
+    std::vector< std::size_t > bounds;
+    for(int t=0; t<=threads; ++t){bounds.push_back(n*t/threads);}
+
+    // every thread's counts of every digit in one go: a digit with one value only is skipped, and since the totals don't depend
+    // on the order, one thread never has to count again
+    const int DIGITS = (8*sizeof(Key) + BITS-1)/BITS;
+    typedef std::array< std::size_t, RADIX > Counts;
+    std::vector< std::vector< Counts > > count(threads, std::vector< Counts >(DIGITS));
+    run_threads(threads, [&](int t){
+        auto& c = count[t];
+        for(auto& digit : c){digit.fill(0);}
+        for(std::size_t i=bounds[t]; i<bounds[t+1]; ++i){
+            Key k = key(items[i]);
+            for(int b=0; b<DIGITS; ++b){++c[b][(unsigned)(k >> BITS*b) & (RADIX-1)];}
+        }
+    });
+
+    std::vector< Item > buffer(n);
+    bool counted = true;    // count[t] is up to date with items
+    for(int b=0; b<DIGITS; ++b){
+        std::size_t top = 0;
+        for(int d=0; d<RADIX; ++d){
+            std::size_t total = 0;
+            for(int t=0; t<threads; ++t){total += count[t][b][d];}
+            top = std::max(top, total);
+        }
+        if(top == n){continue;}
+        TRACE_COUNT("presort/passes");
+        const int shift = BITS*b;
+        if(!counted){
+            run_threads(threads, [&](int t){
+                auto& c = count[t][b];
+                c.fill(0);
+                for(std::size_t i=bounds[t]; i<bounds[t+1]; ++i){++c[(unsigned)(key(items[i]) >> shift) & (RADIX-1)];}
+            });
+        }
+        // where every thread's run of every digit starts: digits in order, threads in order within a digit
+        std::vector< Counts > at(threads);
+        std::size_t offset = 0;
+        for(int d=0; d<RADIX; ++d){
+            for(int t=0; t<threads; ++t){
+                at[t][d] = offset;
+                offset += count[t][b][d];
+            }
+        }
+        run_threads(threads, [&](int t){
+            auto& to = at[t];
+            for(std::size_t i=bounds[t]; i<bounds[t+1]; ++i){buffer[to[(unsigned)(key(items[i]) >> shift) & (RADIX-1)]++] = items[i];}
+        });
+        items.swap(buffer);
+        counted = (threads == 1);
+    }
+}
+
+// the points (x[k*stride], y[k*stride]) for k = 0 .. n-1 in the given order, as a permutation: the result's k-th entry is
+// the index of the k-th point. equal points keep their input order, with dedup only the first of them is in the result
+template< typename T >
+inline std::vector< uint32_t > sort_points(const T* x, const T* y, std::size_t stride, std::size_t n, PointOrder order, bool dedup, int threads = 0){
+    TRACE_SCOPE("presort/points");
+    struct Keyed{
+        PointKey< T > key;
+        uint32_t index;
+    };
+    std::vector< Keyed > keyed(n);
+    for(std::size_t i=0; i<n; ++i){keyed[i] = Keyed{point_key(x[i*stride], y[i*stride], order), (uint32_t)i};}
+    radix_sort(keyed, [](const Keyed& k){return k.key;}, threads);
+    std::vector< uint32_t > out;
+    out.reserve(n);
+    for(std::size_t i=0; i<n; ++i){
+        if(dedup && i > 0 && keyed[i].key == keyed[i-1].key){continue;}
+        out.push_back(keyed[i].index);
+    }
+    TRACE_ADD("presort/duplicates", n - out.size());
+    return out;
+}
+// for coordinates x0 y0 x1 y1 ...
+inline std::vector< uint32_t > sort_points(const std::vector< double >& xy, PointOrder order, bool dedup, int threads = 0){
+    return sort_points(xy.data(), xy.data()+1, 2, xy.size()/2, order, dedup, threads);
+}
+
+}
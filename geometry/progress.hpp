@@ -0,0 +1,37 @@
+// progress reports and early stopping for the long runs (the demos run the algorithms on a worker thread and show how far
+// the sweep got while it's still going, see render/worker.hpp)
+// whoever runs an algorithm may set progress::hook on that thread, the algorithm calls progress::report once per step
+// (an event, a hull attempt...) with how far along it is, and stops with whatever it has so far if the hook says so
+// the hook only runs every 256th report and it's thread_local, so without one a report costs a branch
+
+#pragma once
+
+#include <functional>
+
+namespace progress{
+
+// gets the position of the run (the sweep line's y, for the sweeps), returns false to stop it
+inline thread_local std::function< bool(double) > hook;
+inline thread_local bool stop = false;  // the hook's last answer was false
+
+// false if the run should stop now
+inline bool report(double at){
+    static thread_local unsigned steps = 0;
+    if(!hook || (++steps & 255)){return !stop;}
+    stop = !hook(at);
+    return !stop;
+}
+
+// whether the last run was stopped early (its result is partial)
+inline bool stopped(){return stop;}
+
+// the hook that's set for as long as this is alive
+class Scope{
+    public:
+        Scope(std::function< bool(double) > f){hook = std::move(f); stop = false;}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope(){hook = nullptr; stop = false;}
+};
+
+}
@@ -0,0 +1,591 @@
+// intersections of line segments, Bentley-Ottmann sweep (top to bottom), and all pairs for small inputs
+// plain coordinates, no drawing: the line_intersections demo draws the result
+// coordinates are screen coordinates (y grows downwards)
+// the coordinate type is picked at compile time (see coords.hpp), define GEOM_SEGMENTS_COORD before including to change it
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <cmath>
+#include <limits>
+#include <memory_resource>
+#include <thread>
+#include <atomic>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "arena.hpp"
+#include "coords.hpp"
+#include "presort.hpp"
+#include "progress.hpp"
+#include "trace.hpp"
+
+#ifndef GEOM_SEGMENTS_COORD
+#define GEOM_SEGMENTS_COORD double
+#endif
+
+namespace segments{
+
+typedef coords::Tolerance< -6 > Tol;
+typedef coords::Kernel< GEOM_SEGMENTS_COORD, Tol > K;
+typedef K::coord coord;
+static_assert(std::is_floating_point< coord >::value, "intersection points need floating point coordinates");
+
+inline coord sweep_line_y = K::inf();    // y-coordinate of the sweep line
+inline coord sweep_line_x = -K::inf();   // x-coordinate of the event on it, where horizontal lines in T are (see x_at)
+
+class Point{    // Event
+    public:
+        coord x;
+        coord y;
+        // Lines U; // Event is the key for this value in the std::map Q, so that we may modify U without erase-inserting Event
+        Point(){}
+        Point(coord x, coord y){
+            this->x = x;
+            this->y = y;
+        }
+        bool operator<(const Point &rhs)const{
+            if(!K::close(y,rhs.y)){
+                return (y < rhs.y);   // sfml y-axis inverted
+            }
+            if(!K::close(x,rhs.x)){
+                return (x < rhs.x);
+            }
+            return false;   // if K::close(lhs,rhs) then both lhs<rhs and rhs<lhs must return false.
+        }
+        // void print() const {    // debug
+        //     std::cout << '(' << x << ", " << y << ")" << std::endl;
+        //     return;
+        // }
+};
+
+// the order the sweep takes points in, Q's: the same as Point's, without the tolerance. with it, points less than the
+// tolerance apart in y would go by x, and along a nearly horizontal line that puts points that are still to come before
+// the ones already passed. points closer than the tolerance are still one event, they're merged as they come off Q
+struct SweepOrder{
+    bool operator()(const Point& a, const Point& b) const {
+        if(a.y != b.y){return a.y < b.y;}
+        return a.x < b.x;
+    }
+};
+
+class Line{
+        Point upper, lower;
+
+        coord proj() const { // (lower-upper) -> (x/sqrt(x*x+y*y))
+            coord x = lower.x - upper.x;
+            coord y = lower.y - upper.y;
+            return x/sqrt(x*x + y*y);
+        }
+
+        bool angle_cmp(const Line& rhs) const {            
+            coord proj_a = this->proj();
+            coord proj_b = rhs.proj();
+            if(!K::close(proj_a, proj_b)){
+                return (proj_a < proj_b);
+            }else{  // when lines overlap: any order, as long as both stay in T (an overlap is reported at its ends)
+                return id < rhs.id;
+            }
+        }
+
+    public:
+        int id;     // index of the segment in lines, reported back in Intersection::lines
+
+        Line(coord x1, coord y1, coord x2, coord y2, int id = -1){
+            this->id = id;
+            Point pa(x1,y1);
+            Point pb(x2,y2);
+            if( SweepOrder()(pa, pb) ){
+                upper = pa;
+                lower = pb;
+            }else{
+                lower = pa;
+                upper = pb;
+            }
+        }
+        const Point& upper_end() const {return upper;}
+        const Point& lower_end() const {return lower;}
+        coord x_intercept(const coord& y) const { // assumed that Line segment instersects
+            coord ydiff = lower.y - upper.y;
+            if (K::close(ydiff, 0)){return upper.x;}
+            coord xdiff = lower.x - upper.x;
+            return (xdiff/ydiff)*(y-lower.y) + lower.x;
+        }
+        bool horizontal() const {return lower.y == upper.y;}
+        // where the line is in T when the sweep is at (x,y): its x_intercept, for a horizontal line (all of which is on
+        // the sweep line while it's in T, from its left end to its right end) the point of it closest to x, so it's found
+        // at every event along it
+        coord x_at(coord x, coord y) const {
+            if(horizontal()){return std::min(std::max(x, upper.x), lower.x);}    // upper is the left end
+            return x_intercept(y);
+        }
+        bool operator< (const Line& rhs) const {                    // line < line
+            TRACE_COUNT("segments/compare");
+            coord xa = this->x_at(sweep_line_x, sweep_line_y);
+            coord xb = rhs.x_at(sweep_line_x, sweep_line_y);
+            if(!K::close(xa,xb)){
+                return xa<xb;
+            }else{
+                return angle_cmp(rhs);
+            }
+        }
+        bool operator< (const Point& rhs) const {                   // line < event
+            coord xa = this->x_at(rhs.x, rhs.y);
+            coord xb = rhs.x;
+            if(!K::close(xa,xb)){
+                return xa<xb;
+            }else{
+                return false;
+                /*
+                if event on line, we define 
+                event < line to be true,
+                convenient for calling 
+                T.upper_bound(event)
+                */
+            }
+        }
+        friend bool operator< (const Point& lhs, const Line& rhs) { // event < line
+            coord xa = lhs.x;
+            coord xb = rhs.x_at(lhs.x, lhs.y);
+            if(!K::close(xa,xb)){
+                return xa<xb;
+            }else{
+                return true;
+                /*
+                if event on line, we define 
+                event < line to be true,
+                convenient for calling 
+                T.upper_bound(event)
+                */
+            }
+        }
+        bool is_lower(coord x, coord y) const {
+            return K::close(lower.x, x) && K::close(lower.y, y);
+        }
+        
+        // returns whether there is intersection and if there is, puts it into E
+        // l1.intersect(l2) is different from l2.intersect(l1) in case of horizontal lines
+        bool intersect(const Line& rhs, Point& E) const {
+            TRACE_COUNT("segments/intersect_test");
+            const auto& p1 = upper;
+            const auto& p2 = lower;
+            const auto& p3 = rhs.upper;
+            const auto& p4 = rhs.lower;
+            if(K::close(p3.y, p4.y)){
+                return false;
+            }
+            if(K::close(p1.y, p2.y)){
+                coord x = rhs.x_intercept(p2.y);
+                coord x0 = std::min(p1.x, p2.x), x1 = std::max(p1.x, p2.x);
+                if((x > x1 && !K::close(x, x1)) || (x < x0 && !K::close(x, x0))){return false;}
+                E = Point(x, p2.y); return true;
+            }
+            coord m1 = (p1.x - p2.x)/(p1.y - p2.y);
+            coord m2 = (p3.x - p4.x)/(p3.y - p4.y);
+            if(K::close(m1,m2)){return false;}
+            coord Y = (m1*p1.y - p1.x + p3.x - m2*p3.y)/(m1-m2);
+            coord X = p1.x + m1*(Y-p1.y);
+            if(Y > p2.y || Y > p4.y){return false;} // sfml y-axis is inverted
+            E = Point(X,Y); return true;
+        }
+        // void print() const { // debug
+        //     std::cout << "\t(" << upper.x << ", " << upper.y << ") (" << lower.x << ", " << lower.y << ")" << std::endl;
+        //     return;
+        // }
+};
+
+struct Intersection{
+    Point at;
+    std::vector<int> lines;     // ids of the segments through it
+};
+
+inline std::vector<Line> lines;
+inline std::vector<Intersection> intersections;
+
+// Q, T and the U vectors in Q allocate through memory (see arena.hpp), by default from an arena per run
+inline SweepMemory memory;
+typedef std::pmr::vector<Line> Lines;
+typedef std::pmr::set<Line, std::less<> > Status;
+inline std::pmr::map<Point, Lines, SweepOrder> Q{&memory}; // (key,value) is (point, U)
+inline Status T{&memory};
+inline Lines C{&memory}, L{&memory};   // scratch for handleEvent, kept across events so the arena doesn't fill with their regrowth
+
+// queues the intersection of neighbours l1 and l2 if it's still to come: after event in Q's order (below the sweep line
+// or on it to the right), and not event itself (within the tolerance), whose lines are done with
+inline void checkIntersection(Status::iterator l1, Status::iterator l2, const Point& event){
+    if(l1==T.end() || l2==T.end()){return;}
+    Point E(0,0);
+    bool found = l2->horizontal() ? l2->intersect(*l1, E) : l1->intersect(*l2, E);     // the horizontal one on the left
+    if(!found || !SweepOrder()(event, E) || !(event < E || E < event)){return;}
+    bool pushed = Q.try_emplace(E).second;
+    if(pushed){TRACE_COUNT("segments/event_push");}
+    return;
+}
+
+inline void handleEvent(const Point& event, const Lines& U){
+    C.clear();
+    L.clear();    // don't need this if don't want to report lines of every intersection
+    
+    auto sl = T.end();     // left neighbour 
+    auto sr = T.end();     // right neighbour
+    auto s_ = T.end();     // leftmost in U+C  (s')
+    auto s__ = T.end();    // rightmost in U+C (s")
+
+    auto erase_begin = T.end(); // start of L+C in T
+    // auto erase_end = T.end();   // same as sr
+
+    auto it = T.upper_bound(event); // first element of L+C according to ordering before sweep line update
+    
+    if(it!=T.begin()){sl = std::prev(it);}
+
+    for( ; it != T.end(); ++it){
+        if(!K::close(it->x_at(event.x, event.y), event.x)){break;}
+        
+        if(erase_begin == T.end()){erase_begin = it;}
+
+        bool in_L = it->is_lower(event.x, event.y);
+        if(in_L){L.push_back(*it);}
+        else    {C.push_back(*it);}
+    }
+    sr = it;    // may be reassigned to T.end()
+
+    if(U.size() + L.size() + C.size() >= 2){
+        L.insert(L.end(), U.begin(), U.end()); // intersection lines
+        L.insert(L.end(), C.begin(), C.end());
+        Intersection I{event, {}};
+        for(auto& line : L){I.lines.push_back(line.id);}
+        std::sort(I.lines.begin(), I.lines.end());
+        intersections.push_back(I);
+    }
+
+    // remove L, C
+    if(erase_begin != T.end()){T.erase(erase_begin, sr);}
+    // add U, C after updating sweep_line_y (a horizontal line goes after the others through event, its angle is the largest)
+    sweep_line_y =  event.y;
+    sweep_line_x =  event.x;
+    for(auto line : U){T.insert(line);}
+    for(auto line : C){T.insert(line);}
+
+    // find s' and s" (if they exist)
+    if(U.size()+C.size()){
+        if(sl != T.end()){
+            s_ = std::next(sl);
+        }else{
+            s_ = T.begin();
+        }
+        s__ =  std::prev(sr);
+    }
+
+    if((U.size() + C.size()) == 0){
+        checkIntersection(sl, sr, event);
+    }else{
+        checkIntersection(sl, s_, event);
+        checkIntersection(s__, sr, event);
+    }
+
+    return;
+
+}
+
+// ---- all pairs ----
+// below a few thousand segments, testing every pair is cheaper than building the sweep's trees. the segments go into flat
+// arrays (one per coordinate). a pair is first a bounding box check and then four orientation tests, done four pairs at a
+// time with AVX2 when the cpu has it (scalar otherwise, and for coordinate types other than double). only the pairs that
+// pass get an intersection point, from Line::intersect itself. the upper triangle of the pair matrix is cut into tiles
+// that threads take one at a time
+// the result is what the sweep reports: every point where two or more segments meet (crossings, shared ends, an end on
+// another segment, the ends of collinear overlaps), in sweep order, with the ids of the segments through it
+// horizontal segments get the same treatment as the rest (the crossing is at the other segment's x_intercept, as in
+// Line::intersect), as they do in the sweep: both give the same answer (check.cpp checks it around pairs_below)
+
+#ifndef GEOM_SEGMENTS_PAIRS_BELOW
+#define GEOM_SEGMENTS_PAIRS_BELOW 2000  // measured with bench --segments, see the README
+#endif
+
+inline std::size_t pairs_below = GEOM_SEGMENTS_PAIRS_BELOW;     // find_intersections tests all pairs below this many segments
+
+template< typename C >
+struct SegmentArrays{
+    std::vector< C > ux, uy, lx, ly;    // upper and lower ends (as Line has them)
+    std::vector< C > x0, x1;            // x extent, the y extent is uy .. ly
+    std::vector< C > t;                 // tolerance times length: a point is on the segment's line if |orientation| <= t
+    std::vector< int > id;              // position in lines
+
+    // the segments by their upper end's y, so the ones whose y extent can overlap segment i's come right after it
+    void assign(const std::vector< Line >& lines){
+        std::size_t n = lines.size();
+        id.resize(n);
+        for(std::size_t i=0; i<n; ++i){id[i] = i;}
+        std::sort(id.begin(), id.end(), [&](int a, int b){return lines[a].upper_end().y < lines[b].upper_end().y;});
+        for(auto* v : {&ux, &uy, &lx, &ly, &x0, &x1, &t}){v->resize(n);}
+        for(std::size_t i=0; i<n; ++i){
+            const Point& u = lines[id[i]].upper_end();
+            const Point& l = lines[id[i]].lower_end();
+            ux[i] = u.x; uy[i] = u.y; lx[i] = l.x; ly[i] = l.y;
+            x0[i] = std::min(u.x, l.x); x1[i] = std::max(u.x, l.x);
+            t[i] = Tol::epsilon*std::sqrt((l.x-u.x)*(l.x-u.x) + (l.y-u.y)*(l.y-u.y));
+        }
+    }
+    // (l-u) x (p-u) for segment i
+    C orient(int i, C px, C py) const {return (lx[i]-ux[i])*(py-uy[i]) - (ly[i]-uy[i])*(px-ux[i]);}
+
+    // past the last segment that starts above segment i's lower end (i's window of candidates)
+    int window_end(int i) const {return std::upper_bound(uy.begin()+i+1, uy.end(), ly[i]+Tol::epsilon) - uy.begin();}
+
+    // false if i and j can't meet: their boxes are apart, or one has both ends strictly on one side of the other
+    bool candidate(int i, int j) const {
+        C e = Tol::epsilon;
+        if(x0[j] > x1[i]+e || x0[i] > x1[j]+e || uy[j] > ly[i]+e || uy[i] > ly[j]+e){return false;}
+        C o1 = orient(i, ux[j], uy[j]), o2 = orient(i, lx[j], ly[j]);
+        C o3 = orient(j, ux[i], uy[i]), o4 = orient(j, lx[i], ly[i]);
+        return !((o1 > t[i] && o2 > t[i]) || (o1 < -t[i] && o2 < -t[i]) || (o3 > t[j] && o4 > t[j]) || (o3 < -t[j] && o4 < -t[j]));
+    }
+    // p within tolerance of segment i
+    bool covers(int i, C px, C py) const {
+        if(K::close(ux[i], lx[i]) && K::close(uy[i], ly[i])){return K::close(ux[i], px) && K::close(uy[i], py);}
+        C o = orient(i, px, py);
+        if(o > t[i] || o < -t[i]){return false;}
+        C d = (lx[i]-ux[i])*(px-ux[i]) + (ly[i]-uy[i])*(py-uy[i]);
+        C len2 = (lx[i]-ux[i])*(lx[i]-ux[i]) + (ly[i]-uy[i])*(ly[i]-uy[i]);
+        return d >= -t[i] && d <= len2 + t[i];
+    }
+};
+
+struct PairHit{
+    Point at;
+    int a, b;   // positions in lines
+};
+
+// the point(s) where candidates i and j (positions in s) meet, if they do
+template< typename C >
+inline void refine_pair(const SegmentArrays< C >& s, int i, int j, std::vector< PairHit >& hits){
+    TRACE_COUNT("segments/pair_candidates");
+    auto strict = [](C o, C t){return o > t || o < -t;};
+    bool proper = strict(s.orient(i, s.ux[j], s.uy[j]), s.t[i]) && strict(s.orient(i, s.lx[j], s.ly[j]), s.t[i])
+               && strict(s.orient(j, s.ux[i], s.uy[i]), s.t[j]) && strict(s.orient(j, s.lx[i], s.ly[i]), s.t[j]);
+    int a = s.id[i], b = s.id[j];
+    if(proper){     // a crossing, away from all four ends
+        Point E;
+        bool flat = K::close(s.uy[j], s.ly[j]);     // Line::intersect wants the horizontal one on the left
+        if(flat ? lines[b].intersect(lines[a], E) : lines[a].intersect(lines[b], E)){hits.push_back(PairHit{E, a, b});}
+        return;
+    }
+    // touching: an end of one on the other (for collinear overlaps, the ends of the overlap)
+    if(s.covers(j, s.ux[i], s.uy[i])){hits.push_back(PairHit{Point(s.ux[i], s.uy[i]), a, b});}
+    if(s.covers(j, s.lx[i], s.ly[i])){hits.push_back(PairHit{Point(s.lx[i], s.ly[i]), a, b});}
+    if(s.covers(i, s.ux[j], s.uy[j])){hits.push_back(PairHit{Point(s.ux[j], s.uy[j]), a, b});}
+    if(s.covers(i, s.lx[j], s.ly[j])){hits.push_back(PairHit{Point(s.lx[j], s.ly[j]), a, b});}
+}
+
+// pairs (i, j) for j in [j, end)
+template< typename C >
+inline void pair_row_scalar(const SegmentArrays< C >& s, int i, int j, int end, std::vector< PairHit >& hits){
+    for(; j<end; ++j){
+        if(s.candidate(i, j)){refine_pair(s, i, j, hits);}
+    }
+}
+
+template< typename C >
+inline void pair_row(const SegmentArrays< C >& s, int i, int j, int end, std::vector< PairHit >& hits){
+    pair_row_scalar(s, i, j, end, hits);
+}
+
+#if defined(__x86_64__)
+// the same four at a time. the orientations use the same operations in the same order as SegmentArrays::orient (and no
+// fma), so this filter passes exactly the pairs the scalar one does
+__attribute__((target("avx2")))
+inline __m256d orient_avx2(__m256d dx, __m256d dy, __m256d ax, __m256d ay, __m256d px, __m256d py){
+    return _mm256_sub_pd(_mm256_mul_pd(dx, _mm256_sub_pd(py, ay)), _mm256_mul_pd(dy, _mm256_sub_pd(px, ax)));
+}
+// both beyond t on the same side
+__attribute__((target("avx2")))
+inline __m256d same_side_avx2(__m256d o1, __m256d o2, __m256d t, __m256d nt){
+    __m256d above = _mm256_and_pd(_mm256_cmp_pd(o1, t, _CMP_GT_OQ), _mm256_cmp_pd(o2, t, _CMP_GT_OQ));
+    __m256d below = _mm256_and_pd(_mm256_cmp_pd(o1, nt, _CMP_LT_OQ), _mm256_cmp_pd(o2, nt, _CMP_LT_OQ));
+    return _mm256_or_pd(above, below);
+}
+
+__attribute__((target("avx2")))
+inline void pair_row_avx2(const SegmentArrays< double >& s, int i, int j, int end, std::vector< PairHit >& hits){
+    const __m256d ux = _mm256_set1_pd(s.ux[i]), uy = _mm256_set1_pd(s.uy[i]), lx = _mm256_set1_pd(s.lx[i]), ly = _mm256_set1_pd(s.ly[i]);
+    const __m256d dx = _mm256_set1_pd(s.lx[i]-s.ux[i]), dy = _mm256_set1_pd(s.ly[i]-s.uy[i]);
+    const __m256d ti = _mm256_set1_pd(s.t[i]), nti = _mm256_set1_pd(-s.t[i]);
+    const __m256d x0 = _mm256_set1_pd(s.x0[i]), x1e = _mm256_set1_pd(s.x1[i]+Tol::epsilon);
+    const __m256d uy0 = _mm256_set1_pd(s.uy[i]), lye = _mm256_set1_pd(s.ly[i]+Tol::epsilon);
+    const __m256d e = _mm256_set1_pd(Tol::epsilon), zero = _mm256_setzero_pd();
+    for(; j+4 <= end; j+=4){
+        __m256d bx0 = _mm256_loadu_pd(&s.x0[j]), bx1 = _mm256_loadu_pd(&s.x1[j]);
+        __m256d bux = _mm256_loadu_pd(&s.ux[j]), buy = _mm256_loadu_pd(&s.uy[j]);
+        __m256d blx = _mm256_loadu_pd(&s.lx[j]), bly = _mm256_loadu_pd(&s.ly[j]);
+        // as in candidate: x0[j] > x1[i]+e || x0[i] > x1[j]+e || uy[j] > ly[i]+e || uy[i] > ly[j]+e
+        __m256d apart = _mm256_or_pd(
+            _mm256_or_pd(_mm256_cmp_pd(bx0, x1e, _CMP_GT_OQ), _mm256_cmp_pd(x0, _mm256_add_pd(bx1, e), _CMP_GT_OQ)),
+            _mm256_or_pd(_mm256_cmp_pd(buy, lye, _CMP_GT_OQ), _mm256_cmp_pd(uy0, _mm256_add_pd(bly, e), _CMP_GT_OQ)));
+        if(_mm256_movemask_pd(apart) == 15){continue;}
+        __m256d tj = _mm256_loadu_pd(&s.t[j]), ntj = _mm256_sub_pd(zero, tj);
+        __m256d bdx = _mm256_sub_pd(blx, bux), bdy = _mm256_sub_pd(bly, buy);
+        __m256d reject = _mm256_or_pd(apart, _mm256_or_pd(
+            same_side_avx2(orient_avx2(dx, dy, ux, uy, bux, buy), orient_avx2(dx, dy, ux, uy, blx, bly), ti, nti),
+            same_side_avx2(orient_avx2(bdx, bdy, bux, buy, ux, uy), orient_avx2(bdx, bdy, bux, buy, lx, ly), tj, ntj)));
+        int keep = ~_mm256_movemask_pd(reject) & 15;
+        while(keep){
+            int k = __builtin_ctz(keep);
+            keep &= keep-1;
+            refine_pair(s, i, j+k, hits);
+        }
+    }
+    pair_row_scalar(s, i, j, end, hits);
+}
+
+inline void pair_row(const SegmentArrays< double >& s, int i, int j, int end, std::vector< PairHit >& hits){
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if(avx2){pair_row_avx2(s, i, j, end, hits);}
+    else{pair_row_scalar(s, i, j, end, hits);}
+}
+#endif
+
+// fills intersections from lines by testing all pairs, on up to threads threads (0 means one per core)
+inline void pair_intersections(int threads = 0){
+    TRACE_SCOPE("segments/pairs");
+    intersections.clear();
+    int n = lines.size();
+    for(int i=0; i<n; ++i){lines[i].id = i;}
+    SegmentArrays< coord > s;
+    s.assign(lines);
+
+    // tiles of TILE x TILE pairs, row i only goes as far as its window (the columns past it can't meet i)
+    const int TILE = 256;
+    std::vector< std::pair< int, int > > tiles;     // first row, first column
+    for(int i0=0; i0<n; i0+=TILE){
+        int end = 0;
+        for(int i=i0; i<std::min(n, i0+TILE); ++i){end = std::max(end, s.window_end(i));}
+        for(int j0=i0; j0<end; j0+=TILE){tiles.emplace_back(i0, j0);}
+    }
+    if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+    threads = std::max(1, std::min(threads, (int)tiles.size()/4));   // a handful of tiles each, or it isn't worth a thread
+    std::vector< std::vector< PairHit > > hits(threads);
+    std::atomic< std::size_t > next{0};
+    std::atomic< bool > stop{false};
+    auto work = [&](int w, bool reporting){
+        for(std::size_t k; !stop && (k = next++) < tiles.size();){
+            auto [i0, j0] = tiles[k];
+            int i1 = std::min(n, i0+TILE), j1 = std::min(n, j0+TILE);
+            for(int i=i0; i<i1; ++i){pair_row(s, i, std::max(j0, i+1), std::min(j1, s.window_end(i)), hits[w]);}
+            if(reporting && !progress::report(s.uy[i0])){stop = true;}
+        }
+    };
+    std::vector< std::thread > pool;
+    for(int w=1; w<threads; ++w){pool.emplace_back(work, w, false);}
+    work(0, true);  // progress hooks are per thread, only this one has the caller's
+    for(auto& th : pool){th.join();}
+    if(stop){return;}
+
+    // every hit into the point it's close to (as the sweep's queue merges events), then in sweep order
+    std::map< Point, std::vector< int > > at;
+    for(auto& h : hits){
+        for(auto& p : h){
+            auto& ids = at[p.at];
+            ids.push_back(p.a);
+            ids.push_back(p.b);
+        }
+    }
+    intersections.reserve(at.size());
+    for(auto& [p, ids] : at){
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        intersections.push_back(Intersection{p, std::move(ids)});
+    }
+    TRACE_ADD("segments/pair_tiles", tiles.size());
+}
+
+// the order the sweep takes the ends of lines in (presort::PointOrder::by_y): end 2i is lines[i].upper_end(), 2i+1 its
+// lower_end(). sorted as doubles whatever coord is, the tolerant order of Q still has the last word
+inline std::vector< uint32_t > presort_ends(int threads = 0){
+    std::vector< double > xy(4*lines.size());
+    for(std::size_t i=0; i<lines.size(); ++i){
+        Point u = lines[i].upper_end(), l = lines[i].lower_end();
+        xy[4*i] = u.x; xy[4*i+1] = u.y;
+        xy[4*i+2] = l.x; xy[4*i+3] = l.y;
+    }
+    return presort::sort_points(xy, presort::PointOrder::by_y, false, threads);
+}
+
+// empties Q, T, C and L while what they hold still goes back through memory's current target, then starts memory over on
+// mem (a sweep that was stopped leaves Q and T full), every run starts with this
+inline void reset_sweep(std::pmr::memory_resource* mem){
+    Q.clear();
+    T.clear();
+    Lines(&memory).swap(C);
+    Lines(&memory).swap(L);
+    memory.begin(mem);
+}
+
+// fills intersections from lines by the sweep, ids are the positions in lines, with the ends already in order
+// (ends is presort_ends()), so Q fills up from one end
+// Q and T allocate from mem if given, from a fresh arena otherwise (the last run's is released here)
+inline void sweep_intersections(const std::vector< uint32_t >& ends, std::pmr::memory_resource* mem = nullptr){
+    reset_sweep(mem);
+    intersections.clear();
+    sweep_line_y = K::inf();
+    sweep_line_x = -K::inf();
+    {
+        TRACE_SCOPE("segments/init");
+        for(int i=0; i<(int)lines.size(); ++i){lines[i].id = i;}
+        for(uint32_t k : ends){    // create events
+            const Line& line = lines[k/2];
+            if(k%2 == 0){
+                Q.try_emplace(Q.end(), line.upper_end())->second.push_back(line);  // new or already in Q, either way line goes into its U
+            }else{
+                Q.try_emplace(Q.end(), line.lower_end());
+            }
+        }
+        TRACE_ADD("segments/event_push", Q.size());
+    }
+    TRACE_SCOPE("segments/sweep");
+    while(!Q.empty()){
+        if(!progress::report(sweep_line_y)){break;}    // stopped early, intersections has the ones above the sweep line
+        auto e = Q.extract(Q.begin());  // the node (and its U) stays in the arena, no copy
+        TRACE_COUNT("segments/event_pop");
+        // the events within the tolerance of it are the same point (all of them come within the tolerance in y)
+        for(auto it = Q.begin(); it != Q.end() && K::close(it->first.y, e.key().y);){
+            if(!(it->first < e.key() || e.key() < it->first)){
+                e.mapped().insert(e.mapped().end(), it->second.begin(), it->second.end());
+                it = Q.erase(it);
+            }else{
+                ++it;
+            }
+        }
+        handleEvent(e.key(), e.mapped());
+        TRACE_MAX("segments/max_queue", Q.size());
+        TRACE_MAX("segments/max_status", T.size());
+    }
+    TRACE_ADD("segments/node_allocations", memory.stats().allocations);
+    TRACE_MAX("segments/peak_node_bytes", memory.stats().peak_bytes);
+}
+
+// fills intersections from lines by the sweep, ids are the positions in lines
+inline void sweep_intersections(std::pmr::memory_resource* mem = nullptr){
+    std::vector< uint32_t > ends;
+    {
+        TRACE_SCOPE("segments/presort");
+        ends = presort_ends();
+    }
+    sweep_intersections(ends, mem);
+}
+
+// fills intersections from lines, ids are the positions in lines (sorted, per intersection)
+// all pairs below pairs_below segments, the sweep from there on (with mem as in sweep_intersections)
+inline void find_intersections(std::pmr::memory_resource* mem = nullptr){
+    if(lines.size() < pairs_below){
+        reset_sweep(mem);   // nothing allocated from it this time, its stats say so
+        pair_intersections();
+    }else{
+        sweep_intersections(mem);
+    }
+}
+
+}
@@ -0,0 +1,228 @@
+// binary snapshots of a computed diagram, so it can be saved once and then memory mapped instead of recomputed
+// the file is a fixed header followed by flat arrays, every array is found through a byte offset stored in the header
+// and used in place (no parsing, no copying, nothing allocated per site), so opening a 10M site snapshot costs one mmap
+// and one read-only pass over the arrays to check that every offset and index in them stays in range
+// layout (native little-endian, every array starts on an 8 byte boundary):
+//  header       SnapshotHeader
+//  sites        n x (double x, double y)                          site i is handle i of the triangulation it was saved from
+//  vertices     m x (double x, double y)                          Voronoi vertices (circumcenters), see finite_vertices
+//  cell_offset  (n+1) x uint64                                    cell of site i is cell_vertices[cell_offset[i] .. cell_offset[i+1])
+//  cell_vertices                 x uint32                         vertex indices, counter-clockwise
+//  adjacency_offset (n+1) x uint64                                Delaunay neighbours of site i are adjacency[adjacency_offset[i] .. [i+1])
+//  adjacency                     x uint32                         site indices
+//  edges        e x (uint32 a, uint32 b, uint32 u, uint32 v)      Voronoi edge u-v between the cells of a and b (Delaunay edge a-b)
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include "loader.hpp"
+#include "incremental.hpp"
+
+const char SNAPSHOT_MAGIC[8] = {'G','E','O','S','N','A','P','1'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       // sizeof(SnapshotHeader) of the writer, a reader checks it against its own
+    uint64_t sites;
+    uint64_t vertices;
+    uint64_t finite_vertices;   // vertices [finite_vertices, vertices) are far away stand-ins for the rays of unbounded cells
+    uint64_t cell_entries;
+    uint64_t adjacency_entries;
+    uint64_t edges;
+    // byte offsets from the start of the file
+    uint64_t sites_at;
+    uint64_t vertices_at;
+    uint64_t cell_offset_at;
+    uint64_t cell_vertices_at;
+    uint64_t adjacency_offset_at;
+    uint64_t adjacency_at;
+    uint64_t edges_at;
+};
+
+struct SnapshotEdge{
+    uint32_t a, b;  // sites
+    uint32_t u, v;  // vertices
+};
+
+// writes the diagram of tr, false if the file couldn't be written
+inline bool save_snapshot(const Triangulation& tr, const char* path){
+    typedef Triangulation::Site Site;
+    typedef Triangulation::Triangle Triangle;
+    const int SUPER = Triangulation::SUPER;
+    int n = tr.size();
+
+    // one vertex per alive triangle that has a site in it, triangles clear of the super-triangle are numbered first
+    std::vector< int64_t > vertex_of(tr.tris.size(), -1);
+    std::vector< Site > vertices;
+    uint64_t finite = 0;
+    for(int pass=0; pass<2; ++pass){
+        for(std::size_t t=0; t<tr.tris.size(); ++t){
+            const Triangle& T = tr.tris[t];
+            if(!T.alive){continue;}
+            int supers = (T.v[0] < SUPER) + (T.v[1] < SUPER) + (T.v[2] < SUPER);
+            if(supers == 3 || (supers == 0) != (pass == 0)){continue;}
+            vertex_of[t] = vertices.size();
+            vertices.push_back(tr.circumcenter(t));
+        }
+        if(pass == 0){finite = vertices.size();}
+    }
+
+    std::vector< uint64_t > cell_offset(n+1, 0), adjacency_offset(n+1, 0);
+    std::vector< uint32_t > cell_vertices, adjacency;
+    std::vector< int > around;
+    for(int h=0; h<n; ++h){
+        tr.star(h, around);
+        for(int t : around){
+            cell_vertices.push_back(vertex_of[t]);
+            // going counter-clockwise around h, each triangle adds the vertex after h (a real site unless it's a super vertex)
+            const Triangle& T = tr.tris[t];
+            int i = (T.v[0] == h+SUPER) ? 0 : (T.v[1] == h+SUPER) ? 1 : 2;
+            int next = T.v[(i+1)%3];
+            if(next >= SUPER){adjacency.push_back(next-SUPER);}
+        }
+        around.clear();
+        cell_offset[h+1] = cell_vertices.size();
+        adjacency_offset[h+1] = adjacency.size();
+    }
+
+    std::vector< SnapshotEdge > edges;
+    for(std::size_t t=0; t<tr.tris.size(); ++t){
+        const Triangle& T = tr.tris[t];
+        if(!T.alive){continue;}
+        for(int i=0; i<3; ++i){
+            int a = T.v[(i+1)%3], b = T.v[(i+2)%3];
+            if(a < SUPER || b < SUPER || T.n[i] < (int)t){continue;}
+            edges.push_back(SnapshotEdge{(uint32_t)(a-SUPER), (uint32_t)(b-SUPER), (uint32_t)vertex_of[t], (uint32_t)vertex_of[T.n[i]]});
+        }
+    }
+
+    SnapshotHeader head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, SNAPSHOT_MAGIC, 8);
+    head.version = SNAPSHOT_VERSION;
+    head.header_size = sizeof(SnapshotHeader);
+    head.sites = n;
+    head.vertices = vertices.size();
+    head.finite_vertices = finite;
+    head.cell_entries = cell_vertices.size();
+    head.adjacency_entries = adjacency.size();
+    head.edges = edges.size();
+    uint64_t at = sizeof(SnapshotHeader);
+    auto place = [&](uint64_t bytes){
+        uint64_t here = at;
+        at = (at + bytes + 7) & ~(uint64_t)7;
+        return here;
+    };
+    head.sites_at = place(n*sizeof(Site));
+    head.vertices_at = place(vertices.size()*sizeof(Site));
+    head.cell_offset_at = place(cell_offset.size()*8);
+    head.cell_vertices_at = place(cell_vertices.size()*4);
+    head.adjacency_offset_at = place(adjacency_offset.size()*8);
+    head.adjacency_at = place(adjacency.size()*4);
+    head.edges_at = place(edges.size()*sizeof(SnapshotEdge));
+
+    FILE* f = fopen(path, "wb");
+    if(!f){return false;}
+    bool ok = fwrite(&head, sizeof(head), 1, f) == 1;
+    auto section = [&](uint64_t offset, const void* data, uint64_t bytes){
+        static const char zeros[8] = {0};
+        long pos = ftell(f);
+        if(pos < 0 || (uint64_t)pos > offset){ok = false; return;}
+        ok = ok && fwrite(zeros, 1, offset-pos, f) == offset-pos;
+        ok = ok && (bytes == 0 || fwrite(data, 1, bytes, f) == bytes);
+    };
+    section(head.sites_at, tr.sites.data()+SUPER, n*sizeof(Site));
+    section(head.vertices_at, vertices.data(), vertices.size()*sizeof(Site));
+    section(head.cell_offset_at, cell_offset.data(), cell_offset.size()*8);
+    section(head.cell_vertices_at, cell_vertices.data(), cell_vertices.size()*4);
+    section(head.adjacency_offset_at, adjacency_offset.data(), adjacency_offset.size()*8);
+    section(head.adjacency_at, adjacency.data(), adjacency.size()*4);
+    section(head.edges_at, edges.data(), edges.size()*sizeof(SnapshotEdge));
+    section(at, nullptr, 0);    // pad the end too, so even an empty last array lies inside the file
+    return (fclose(f) == 0) && ok;
+}
+
+// a mapped snapshot, all the arrays point straight into the file (ok is false if it isn't a complete snapshot of this version)
+class Snapshot{
+        MappedFile file;
+
+        template< typename T >
+        const T* array(uint64_t at, uint64_t count){
+            if(at%8 != 0 || at > file.size || count > (file.size-at)/sizeof(T)){ok = false; return nullptr;}
+            return (const T*)(file.data+at);
+        }
+        // every count of the header (which is untrusted) has to fit the file on its own, at the smallest element size, so
+        // that head.sites+1 and the like can't wrap, and has to fit a size_t
+        bool counts_fit() const {
+            uint64_t limit = std::min< uint64_t >(file.size, SIZE_MAX)/sizeof(uint32_t);
+            for(uint64_t c : {head.sites, head.vertices, head.finite_vertices, head.cell_entries, head.adjacency_entries, head.edges}){
+                if(c > limit){return false;}
+            }
+            return head.finite_vertices <= head.vertices;
+        }
+        // an offset array has to start at 0, never go down and end at its number of entries
+        static bool offsets_fit(const uint64_t* offset, uint64_t n, uint64_t entries){
+            if(offset[0] != 0 || offset[n] != entries){return false;}
+            for(uint64_t i=0; i<n; ++i){
+                if(offset[i+1] < offset[i]){return false;}
+            }
+            return true;
+        }
+        // every index has to be below the count of what it indexes
+        static bool indices_fit(const uint32_t* index, uint64_t count, uint64_t limit){
+            for(uint64_t i=0; i<count; ++i){
+                if(index[i] >= limit){return false;}
+            }
+            return true;
+        }
+        bool edges_fit() const {
+            for(uint64_t i=0; i<head.edges; ++i){
+                auto& e = edges[i];
+                if(e.a >= head.sites || e.b >= head.sites || e.u >= head.vertices || e.v >= head.vertices){return false;}
+            }
+            return true;
+        }
+    public:
+        typedef Triangulation::Site Site;
+
+        bool ok = false;
+        SnapshotHeader head;
+        const Site* sites = nullptr;
+        const Site* vertices = nullptr;
+        const uint64_t* cell_offset = nullptr;
+        const uint32_t* cell_vertices = nullptr;
+        const uint64_t* adjacency_offset = nullptr;
+        const uint32_t* adjacency = nullptr;
+        const SnapshotEdge* edges = nullptr;
+
+        Snapshot(const char* path) : file(path){
+            if(!file.ok || file.size < sizeof(SnapshotHeader)){return;}
+            memcpy(&head, file.data, sizeof(head));
+            if(memcmp(head.magic, SNAPSHOT_MAGIC, 8) != 0 || head.version != SNAPSHOT_VERSION || head.header_size != sizeof(SnapshotHeader)){return;}
+            if(!counts_fit()){return;}
+            ok = true;
+            sites = array< Site >(head.sites_at, head.sites);
+            vertices = array< Site >(head.vertices_at, head.vertices);
+            cell_offset = array< uint64_t >(head.cell_offset_at, head.sites+1);
+            cell_vertices = array< uint32_t >(head.cell_vertices_at, head.cell_entries);
+            adjacency_offset = array< uint64_t >(head.adjacency_offset_at, head.sites+1);
+            adjacency = array< uint32_t >(head.adjacency_at, head.adjacency_entries);
+            edges = array< SnapshotEdge >(head.edges_at, head.edges);
+            // nothing in the arrays is trusted either, the accessors below and the callers index with it unchecked
+            ok = ok && offsets_fit(cell_offset, head.sites, head.cell_entries) && offsets_fit(adjacency_offset, head.sites, head.adjacency_entries);
+            ok = ok && indices_fit(cell_vertices, head.cell_entries, head.vertices) && indices_fit(adjacency, head.adjacency_entries, head.sites);
+            ok = ok && edges_fit();
+        }
+
+        uint64_t size() const {return head.sites;}
+        bool is_far(uint32_t vertex) const {return vertex >= head.finite_vertices;}
+        uint64_t cell_size(uint64_t site) const {return cell_offset[site+1] - cell_offset[site];}
+        uint64_t degree(uint64_t site) const {return adjacency_offset[site+1] - adjacency_offset[site];}
+};
@@ -0,0 +1,305 @@
+// tiled Voronoi/Delaunay for point sets too big to triangulate in one go
+// sites are partitioned into a grid of tiles, each tile is triangulated on its own (on a pool of threads) together with a
+// halo of neighbouring sites, and only the parts of the result that are proven to be globally correct are kept:
+//  - a triangle is final once its circumcircle holds no site at all, the same empty circle test that defines the Delaunay
+//    triangulation (local sites can't be in it, it's a local Delaunay triangle, so only sites outside tile+halo can spoil it)
+//  - a point q of the Voronoi cell of s is final once no site is closer to q than s is
+// both are free when the disk lies inside the tile+halo, otherwise they are answered by a read-only bucket grid over all sites
+// (only the buckets the disk touches), and a local hull edge is checked against the tile+halo and the corners of the global hull
+// if something does fail, the sites that spoiled it are added to the tile and it is redone (triangles along the hull are long
+// and thin, widening the halo for them would soon pull in the whole input), so a worker only ever triangulates the sites of
+// its tile, a thin halo and the few far away sites that really are its Delaunay neighbours
+// stitching is deterministic: every triangle is reported by exactly one tile (the tile of its smallest site index),
+// cells are reported as pieces clipped to the tile bounds (instead of extending edges to infinity), sorted by (site, tile),
+// so the output doesn't depend on the number of threads or on which tile finished first
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include "incremental.hpp"
+
+class TiledDiagram{
+    public:
+        typedef Triangulation::Site Site;
+        struct Piece{
+            int site;       // index into the input
+            int tile;       // tile_y*tiles_x + tile_x
+            int begin, end; // polygon (counter-clockwise) is vertices[begin .. end)
+        };
+
+        std::vector< std::array<int,3> > triangles; // Delaunay triangles as input indices, smallest index first, sorted
+        std::vector< Piece > pieces;                // pieces of Voronoi cells clipped to tiles, sorted by (site, tile)
+        std::vector< Site > vertices;
+
+        int tiles_x = 1, tiles_y = 1;
+        double x_min = 0, y_min = 0, x_max = 0, y_max = 0; // bounding box of the input, the tiles partition it
+        std::vector< int > tile_rounds;                     // per tile, how often it had to be redone
+        std::vector< int > tile_sites;                      // per tile, how many sites its worker triangulated in the end
+
+    private:
+        struct TileResult{
+            std::vector< std::array<int,3> > triangles;
+            std::vector< Piece > pieces;
+            std::vector< Site > vertices;
+        };
+
+        const double* xy = nullptr;
+        int n = 0;
+
+        // bucket grid over all sites (a couple per bucket), sites of bucket b are bucket_sites[bucket_start[b] .. bucket_start[b+1]), ascending
+        int gw = 1, gh = 1;
+        std::vector< int > bucket_start, bucket_sites;
+        std::vector< int > hull;    // corners of the convex hull of all sites (see site_beyond)
+
+        int bucket_x(double x) const {return std::min(std::max((int)((x-x_min)/(x_max-x_min)*gw), 0), gw-1);}
+        int bucket_y(double y) const {return std::min(std::max((int)((y-y_min)/(y_max-y_min)*gh), 0), gh-1);}
+        double bucket_x0(int i) const {return x_min + (x_max-x_min)*i/gw;}
+        double bucket_y0(int j) const {return y_min + (y_max-y_min)*j/gh;}
+        int tile_x_of(double x) const {return std::min(std::max((int)((x-x_min)/(x_max-x_min)*tiles_x), 0), tiles_x-1);}
+        int tile_y_of(double y) const {return std::min(std::max((int)((y-y_min)/(y_max-y_min)*tiles_y), 0), tiles_y-1);}
+
+        // appends the sites strictly inside the disk to out, false if there are none (sites on the circle don't count, those are the triangle's own vertices)
+        bool sites_in_disk(double cx, double cy, double r, std::vector< int >& out) const {
+            double r2 = r*r*(1-1e-9);
+            std::size_t found = out.size();
+            for(int j=bucket_y(cy-r); j<=bucket_y(cy+r); ++j){
+                for(int i=bucket_x(cx-r); i<=bucket_x(cx+r); ++i){
+                    double nx = std::min(std::max(cx, bucket_x0(i)), bucket_x0(i+1));
+                    double ny = std::min(std::max(cy, bucket_y0(j)), bucket_y0(j+1));
+                    if((nx-cx)*(nx-cx) + (ny-cy)*(ny-cy) >= r2){continue;}  // bucket misses the disk
+                    int b = j*gw + i;
+                    for(int k=bucket_start[b]; k<bucket_start[b+1]; ++k){
+                        int s = bucket_sites[k];
+                        if((xy[2*s]-cx)*(xy[2*s]-cx) + (xy[2*s+1]-cy)*(xy[2*s+1]-cy) < r2){out.push_back(s);}
+                    }
+                }
+            }
+            return out.size() > found;
+        }
+
+        // the site farthest to the left of a->b (the outside of a hull edge, a hull triangle's "circumcircle"), -1 if there is none
+        // only the buckets of the tile+halo box [ex0,ex1]x[ey0,ey1] are searched, a site outside it that is farther left is
+        // found among the corners of the input's hull (the site farthest beyond a line always is one), not by walking the grid
+        int site_beyond(const Site& a, const Site& b, double ex0, double ey0, double ex1, double ey1) const {
+            double tol = 1e-9*std::hypot(b.x-a.x, b.y-a.y)*std::max(x_max-x_min, y_max-y_min);
+            auto left = [&](double x, double y){return (b.x-a.x)*(y-a.y) - (b.y-a.y)*(x-a.x);};
+            int best = -1;
+            double best_left = tol;
+            for(int j=bucket_y(ey0); j<=bucket_y(ey1); ++j){
+                for(int i=bucket_x(ex0); i<=bucket_x(ex1); ++i){
+                    double x0 = bucket_x0(i), x1 = bucket_x0(i+1), y0 = bucket_y0(j), y1 = bucket_y0(j+1);
+                    if(std::max(std::max(left(x0,y0), left(x1,y0)), std::max(left(x0,y1), left(x1,y1))) <= best_left){continue;}
+                    int c = j*gw + i;
+                    for(int k=bucket_start[c]; k<bucket_start[c+1]; ++k){
+                        int s = bucket_sites[k];
+                        double l = left(xy[2*s], xy[2*s+1]);
+                        if(l > best_left){best_left = l; best = s;}
+                    }
+                }
+            }
+            for(int s : hull){
+                double x = xy[2*s], y = xy[2*s+1];
+                if(x >= ex0 && x <= ex1 && y >= ey0 && y <= ey1){continue;}    // its bucket was searched
+                double l = left(x, y);
+                if(l > best_left){best_left = l; best = s;}
+            }
+            return best;
+        }
+
+        // corners of the convex hull of all sites, by Andrew's monotone chain
+        void make_hull(){
+            std::vector< int > order(n);
+            for(int i=0; i<n; ++i){order[i] = i;}
+            std::sort(order.begin(), order.end(), [&](int i, int j){
+                return xy[2*i] < xy[2*j] || (xy[2*i] == xy[2*j] && xy[2*i+1] < xy[2*j+1]);
+            });
+            if(n < 3){hull = order; return;}
+            auto cross = [&](int o, int a, int b){
+                return (xy[2*a]-xy[2*o])*(xy[2*b+1]-xy[2*o+1]) - (xy[2*a+1]-xy[2*o+1])*(xy[2*b]-xy[2*o]);
+            };
+            hull.assign(2*n, 0);
+            int k = 0;
+            for(int i=0; i<n; ++i){
+                while(k >= 2 && cross(hull[k-2], hull[k-1], order[i]) <= 0){--k;}
+                hull[k++] = order[i];
+            }
+            for(int i=n-2, lower=k+1; i>=0; --i){
+                while(k >= lower && cross(hull[k-2], hull[k-1], order[i]) <= 0){--k;}
+                hull[k++] = order[i];
+            }
+            hull.resize(std::max(k-1, 1));
+            hull.shrink_to_fit();
+        }
+
+        // triangulates the sites of the tile+halo box plus extra, false if that wasn't enough (the culprits are appended to extra)
+        bool compute_tile(int tile, double halo, std::vector< int >& extra, TileResult& out){
+            int tx = tile%tiles_x, ty = tile/tiles_x;
+            double bx0 = x_min + (x_max-x_min)*tx/tiles_x, bx1 = x_min + (x_max-x_min)*(tx+1)/tiles_x;
+            double by0 = y_min + (y_max-y_min)*ty/tiles_y, by1 = y_min + (y_max-y_min)*(ty+1)/tiles_y;
+            double ex0 = bx0-halo, ex1 = bx1+halo, ey0 = by0-halo, ey1 = by1+halo;
+
+            // a disk inside the tile+halo box can only hold local sites, a side of the box past the input's bounding box has no sites beyond it
+            bool open_l = ex0 <= x_min, open_r = ex1 >= x_max, open_b = ey0 <= y_min, open_t = ey1 >= y_max;
+            std::size_t culprits = extra.size();
+            auto empty_disk = [&](double cx, double cy, double r){
+                bool inside = (open_l || cx-r >= ex0) && (open_r || cx+r <= ex1) && (open_b || cy-r >= ey0) && (open_t || cy+r <= ey1);
+                return inside || !sites_in_disk(cx, cy, r, extra);
+            };
+
+            std::vector< int > local;   // local handle -> input index
+            for(int j=bucket_y(ey0); j<=bucket_y(ey1); ++j){
+                for(int i=bucket_x(ex0); i<=bucket_x(ex1); ++i){
+                    for(int k=bucket_start[j*gw+i]; k<bucket_start[j*gw+i+1]; ++k){
+                        int s = bucket_sites[k];
+                        if(xy[2*s] >= ex0 && xy[2*s] <= ex1 && xy[2*s+1] >= ey0 && xy[2*s+1] <= ey1){local.push_back(s);}
+                    }
+                }
+            }
+            local.insert(local.end(), extra.begin(), extra.end());
+            std::sort(local.begin(), local.end());  // insertion order fixed by input order, for determinism
+            local.erase(std::unique(local.begin(), local.end()), local.end());
+
+            double lx0 = ex0, lx1 = ex1, ly0 = ey0, ly1 = ey1;    // culprits can be outside the box
+            for(int s : extra){
+                lx0 = std::min(lx0, xy[2*s]); lx1 = std::max(lx1, xy[2*s]);
+                ly0 = std::min(ly0, xy[2*s+1]); ly1 = std::max(ly1, xy[2*s+1]);
+            }
+            Triangulation tr(lx0, ly0, lx1, ly1);
+            tr.reserve(local.size());
+            std::vector< int > global;
+            for(int s : local){
+                int h = tr.insert(xy[2*s], xy[2*s+1]);
+                if(h == (int)global.size()){global.push_back(s);}   // else a duplicate of an earlier site
+            }
+            if(global.size() < 3 && !(open_l && open_r && open_b && open_t)){
+                // next to nothing here (the sparse fringe of the input), borrow the closest few sites instead of growing the halo into the dense part
+                std::vector< int > near;
+                for(double r = std::hypot(bx1-bx0, by1-by0); near.size() < 3 && r < 4*std::hypot(x_max-x_min, y_max-y_min); r *= 2){
+                    near.clear();
+                    sites_in_disk((bx0+bx1)/2, (by0+by1)/2, r, near);
+                }
+                extra.insert(extra.end(), near.begin(), near.end());
+                return false;
+            }
+            auto owned = [&](int s){return tile_x_of(xy[2*s]) == tx && tile_y_of(xy[2*s+1]) == ty;};
+
+            out = TileResult();
+            std::vector< int > around;
+            for(int h=0; h<(int)global.size(); ++h){
+                int s = global[h];
+                if(owned(s)){
+                    // the whole star of an owned site must be final, then it is the star of the site in the global triangulation
+                    around.clear();
+                    tr.star(h, around);
+                    for(int t : around){
+                        const Triangulation::Triangle& T = tr.tris[t];
+                        int supers = tr.is_super(T.v[0]) + tr.is_super(T.v[1]) + tr.is_super(T.v[2]);
+                        if(supers == 1){
+                            // the local hull edge a->b has to be on the global hull
+                            int k = tr.is_super(T.v[0]) ? 0 : tr.is_super(T.v[1]) ? 1 : 2;
+                            int beyond = (open_l && open_r && open_b && open_t) ? -1 : site_beyond(tr.sites[T.v[(k+1)%3]], tr.sites[T.v[(k+2)%3]], ex0, ey0, ex1, ey1);
+                            if(beyond >= 0){extra.push_back(beyond);}
+                        }
+                        if(supers > 0){continue;}   // triangles with two super vertices only sit between two such hull edges
+                        Site c = tr.circumcenter(t);
+                        if(!empty_disk(c.x, c.y, std::hypot(tr.sites[T.v[0]].x-c.x, tr.sites[T.v[0]].y-c.y))){continue;}
+                        std::array<int,3> tri = {global[T.v[0]-Triangulation::SUPER], global[T.v[1]-Triangulation::SUPER], global[T.v[2]-Triangulation::SUPER]};
+                        int m = std::min_element(tri.begin(), tri.end()) - tri.begin();
+                        std::rotate(tri.begin(), tri.begin()+m, tri.end());  // smallest first, orientation kept
+                        if(tri[0] == s){out.triangles.push_back(tri);}      // reported by the tile owning its smallest site
+                    }
+                }
+                // any site's cell can reach into the tile, keep the part inside (for owned sites and halo sites alike)
+                // the distance to s is convex over the piece, so checking its corners covers all of it
+                auto poly = clip_to_box(tr.cell(h), bx0, by0, bx1, by1);
+                if(poly.empty()){continue;}
+                bool final = true;
+                for(auto& q : poly){
+                    final = empty_disk(q.x, q.y, std::hypot(q.x-xy[2*s], q.y-xy[2*s+1])) && final;
+                }
+                if(!final){continue;}
+                out.pieces.push_back(Piece{s, tile, (int)out.vertices.size(), (int)(out.vertices.size()+poly.size())});
+                out.vertices.insert(out.vertices.end(), poly.begin(), poly.end());
+            }
+            tile_sites[tile] = global.size();
+            return extra.size() == culprits;
+        }
+
+    public:
+        // coords is the flat coordinate array (x0,y0,x1,y1,...), threads = 0 means one per core
+        TiledDiagram(const std::vector< double >& coords, int tiles_x, int tiles_y, int threads = 0){
+            this->tiles_x = std::max(tiles_x, 1);
+            this->tiles_y = std::max(tiles_y, 1);
+            xy = coords.data();
+            n = coords.size()/2;
+            int T = this->tiles_x*this->tiles_y;
+            tile_rounds.assign(T, 0);
+            tile_sites.assign(T, 0);
+            if(n == 0){return;}
+            x_min = x_max = xy[0];
+            y_min = y_max = xy[1];
+            for(int i=1; i<n; ++i){
+                x_min = std::min(x_min, xy[2*i]); x_max = std::max(x_max, xy[2*i]);
+                y_min = std::min(y_min, xy[2*i+1]); y_max = std::max(y_max, xy[2*i+1]);
+            }
+            if(x_max-x_min < Triangulation::eps){x_max = x_min+1;}
+            if(y_max-y_min < Triangulation::eps){y_max = y_min+1;}
+
+            // about 2 sites per bucket, counting sort keeps every bucket in input order
+            double spacing = std::sqrt((x_max-x_min)*(y_max-y_min)/n);
+            gw = std::min(std::max(1, (int)((x_max-x_min)/spacing/1.4)), 1<<15);
+            gh = std::min(std::max(1, (int)((y_max-y_min)/spacing/1.4)), 1<<15);
+            bucket_start.assign((std::size_t)gw*gh+1, 0);
+            for(int i=0; i<n; ++i){++bucket_start[bucket_y(xy[2*i+1])*gw + bucket_x(xy[2*i]) + 1];}
+            for(std::size_t b=0; b+1<bucket_start.size(); ++b){bucket_start[b+1] += bucket_start[b];}
+            bucket_sites.resize(n);
+            std::vector< int > fill(bucket_start.begin(), bucket_start.end()-1);
+            for(int i=0; i<n; ++i){bucket_sites[fill[bucket_y(xy[2*i+1])*gw + bucket_x(xy[2*i])]++] = i;}
+            make_hull();
+
+            // start with a halo of a few average site spacings, it only has to grow if a round turned up no new culprits
+            // (they were all duplicates of sites the tile already had, or the tile has almost no sites)
+            std::vector< TileResult > results(T);
+            std::atomic<int> next(0);
+            auto worker = [&](){
+                for(int tile = next++; tile < T; tile = next++){
+                    double halo = 4*spacing;
+                    std::vector< int > extra;
+                    while(true){
+                        std::size_t before = extra.size();
+                        if(compute_tile(tile, halo, extra, results[tile])){break;}
+                        ++tile_rounds[tile];
+                        std::sort(extra.begin(), extra.end());
+                        extra.erase(std::unique(extra.begin(), extra.end()), extra.end());
+                        if(extra.size() <= before){halo *= 2;}
+                    }
+                }
+            };
+            if(threads <= 0){threads = std::max(1u, std::thread::hardware_concurrency());}
+            std::vector< std::thread > pool;
+            for(int t=1; t<std::min(threads, T); ++t){pool.emplace_back(worker);}
+            worker();
+            for(auto& th : pool){th.join();}
+
+            for(auto& r : results){
+                triangles.insert(triangles.end(), r.triangles.begin(), r.triangles.end());
+                for(auto p : r.pieces){
+                    p.begin += vertices.size();
+                    p.end += vertices.size();
+                    pieces.push_back(p);
+                }
+                vertices.insert(vertices.end(), r.vertices.begin(), r.vertices.end());
+                r = TileResult();
+            }
+            std::sort(triangles.begin(), triangles.end());
+            std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b){
+                return a.site < b.site || (a.site == b.site && a.tile < b.tile);
+            });
+        }
+};
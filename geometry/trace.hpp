@@ -0,0 +1,217 @@
+// instrumentation for finding out where the time goes, compiled out unless GEOM_TRACE is defined
+//  TRACE_SCOPE("name")         times the rest of the enclosing block as a phase (meant for phases, not for hot calls)
+//  TRACE_COUNT("name")         counts one more of something (predicate calls, queue pushes...)
+//  TRACE_ADD("name", v)        counts v more
+//  TRACE_MAX("name", v)        keeps the largest v seen (sizes and depths)
+//  TRACE_ALLOCATIONS()         at file scope in exactly one .cpp: replaces every form of global new/delete (array, sized,
+//                              aligned, nothrow) to count allocations, bytes and deallocations
+// without GEOM_TRACE all of them expand to nothing, so they can stay in the hot paths
+// counters are looked up once per call site and bumped with a relaxed atomic add, phases take a lock when they end
+// trace::write_json() writes the counters and per-phase totals, trace::write_chrome() the phases as a trace-event file
+// (load it in chrome://tracing or https://ui.perfetto.dev)
+
+#pragma once
+
+#ifdef GEOM_TRACE
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+namespace trace{
+
+typedef std::chrono::steady_clock Clock;
+
+struct Counter{
+    const char* name;
+    std::atomic< uint64_t > value{0};
+
+    Counter(const char* name) : name(name){}
+    void add(uint64_t v){value.fetch_add(v, std::memory_order_relaxed);}
+    void max(uint64_t v){
+        uint64_t cur = value.load(std::memory_order_relaxed);
+        while(v > cur && !value.compare_exchange_weak(cur, v, std::memory_order_relaxed)){}
+    }
+};
+
+struct Event{
+    const char* name;
+    uint32_t tid;
+    int64_t begin_us, dur_us;
+};
+
+struct State{
+    std::mutex lock;
+    std::deque< Counter > counters;     // deque: counters never move once handed out
+    std::vector< Event > events;
+    std::vector< std::thread::id > threads;
+    Clock::time_point start = Clock::now();
+};
+
+// bumped by TRACE_ALLOCATIONS, if it's used
+inline std::atomic< uint64_t > allocations{0}, allocated_bytes{0}, deallocations{0};
+
+// what every form of TRACE_ALLOCATIONS' operator new and delete comes down to (align 0 means the default alignment),
+// they all allocate with malloc/aligned_alloc so every form of delete frees with free, whichever new it got the pointer from
+// (kept out of line so the compiler doesn't pair an inlined new expression with free)
+__attribute__((noinline)) inline void* allocate(std::size_t n, std::size_t align){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    if(n == 0){n = 1;}
+    if(align <= alignof(std::max_align_t)){return std::malloc(n);}
+    return std::aligned_alloc(align, (n + align-1)/align*align);
+}
+inline void* allocate_or_throw(std::size_t n, std::size_t align){
+    if(void* p = allocate(n, align)){return p;}
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) inline void release(void* p){
+    if(!p){return;}
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+
+inline State& state(){
+    static State s;
+    return s;
+}
+
+inline Counter& counter(const char* name){
+    State& s = state();
+    std::lock_guard< std::mutex > guard(s.lock);
+    for(auto& c : s.counters){
+        if(std::string(c.name) == name){return c;}
+    }
+    s.counters.emplace_back(name);
+    return s.counters.back();
+}
+
+// small ids for the trace viewer, in order of first appearance (call with the lock held)
+inline uint32_t thread_number(State& s){
+    auto id = std::this_thread::get_id();
+    for(std::size_t i=0; i<s.threads.size(); ++i){
+        if(s.threads[i] == id){return i;}
+    }
+    s.threads.push_back(id);
+    return s.threads.size()-1;
+}
+
+class Scope{
+        const char* name;
+        Clock::time_point begin;
+    public:
+        Scope(const char* name) : name(name), begin(Clock::now()){}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope(){
+            auto end = Clock::now();
+            State& s = state();
+            std::lock_guard< std::mutex > guard(s.lock);
+            auto us = [&](Clock::time_point t){return std::chrono::duration_cast< std::chrono::microseconds >(t-s.start).count();};
+            s.events.push_back(Event{name, thread_number(s), us(begin), us(end)-us(begin)});
+        }
+};
+
+// counters and, per phase, how often it ran and its total time
+inline bool write_json(const char* path){
+    FILE* f = fopen(path, "w");
+    if(!f){return false;}
+    State& s = state();
+    std::lock_guard< std::mutex > guard(s.lock);
+    fprintf(f, "{\n  \"counters\": {");
+    for(std::size_t i=0; i<s.counters.size(); ++i){
+        fprintf(f, "%s\n    \"%s\": %llu", i ? "," : "", s.counters[i].name, (unsigned long long)s.counters[i].value.load());
+    }
+    fprintf(f, "\n  },\n  \"allocations\": %llu,\n  \"allocated_bytes\": %llu,\n  \"deallocations\": %llu,\n  \"phases\": {",
+            (unsigned long long)allocations.load(), (unsigned long long)allocated_bytes.load(), (unsigned long long)deallocations.load());
+    std::vector< const char* > names;
+    for(auto& e : s.events){
+        bool seen = false;
+        for(auto n : names){seen = seen || std::string(n) == e.name;}
+        if(!seen){names.push_back(e.name);}
+    }
+    for(std::size_t i=0; i<names.size(); ++i){
+        uint64_t calls = 0;
+        int64_t total = 0;
+        for(auto& e : s.events){
+            if(std::string(e.name) == names[i]){++calls; total += e.dur_us;}
+        }
+        fprintf(f, "%s\n    \"%s\": {\"calls\": %llu, \"total_ms\": %.3f}", i ? "," : "", names[i], (unsigned long long)calls, total/1000.0);
+    }
+    fprintf(f, "\n  }\n}\n");
+    return fclose(f) == 0;
+}
+
+// the phases as complete ("X") events and the counters as one counter ("C") event at the end
+inline bool write_chrome(const char* path){
+    FILE* f = fopen(path, "w");
+    if(!f){return false;}
+    State& s = state();
+    std::lock_guard< std::mutex > guard(s.lock);
+    fprintf(f, "{\"traceEvents\": [");
+    const char* sep = "";
+    int64_t last = 0;
+    for(auto& e : s.events){
+        fprintf(f, "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %lld, \"dur\": %lld}",
+                sep, e.name, e.tid, (long long)e.begin_us, (long long)e.dur_us);
+        last = std::max(last, e.begin_us + e.dur_us);
+        sep = ",";
+    }
+    for(auto& c : s.counters){
+        fprintf(f, "%s\n{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"tid\": 0, \"ts\": %lld, \"args\": {\"value\": %llu}}",
+                sep, c.name, (long long)last, (unsigned long long)c.value.load());
+        sep = ",";
+    }
+    fprintf(f, "\n], \"displayTimeUnit\": \"ms\"}\n");
+    return fclose(f) == 0;
+}
+
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_ADD(name, v) do{static trace::Counter& c_ = trace::counter(name); c_.add(v);}while(0)
+#define TRACE_COUNT(name) TRACE_ADD(name, 1)
+#define TRACE_MAX(name, v) do{static trace::Counter& c_ = trace::counter(name); c_.max(v);}while(0)
+#define TRACE_ALLOCATIONS() \
+    void* operator new(std::size_t n){return trace::allocate_or_throw(n, 0);} \
+    void* operator new[](std::size_t n){return trace::allocate_or_throw(n, 0);} \
+    void* operator new(std::size_t n, std::align_val_t a){return trace::allocate_or_throw(n, (std::size_t)a);} \
+    void* operator new[](std::size_t n, std::align_val_t a){return trace::allocate_or_throw(n, (std::size_t)a);} \
+    void* operator new(std::size_t n, const std::nothrow_t&) noexcept {return trace::allocate(n, 0);} \
+    void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {return trace::allocate(n, 0);} \
+    void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {return trace::allocate(n, (std::size_t)a);} \
+    void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {return trace::allocate(n, (std::size_t)a);} \
+    void operator delete(void* p) noexcept {trace::release(p);} \
+    void operator delete[](void* p) noexcept {trace::release(p);} \
+    void operator delete(void* p, std::size_t) noexcept {trace::release(p);} \
+    void operator delete[](void* p, std::size_t) noexcept {trace::release(p);} \
+    void operator delete(void* p, std::align_val_t) noexcept {trace::release(p);} \
+    void operator delete[](void* p, std::align_val_t) noexcept {trace::release(p);} \
+    void operator delete(void* p, std::size_t, std::align_val_t) noexcept {trace::release(p);} \
+    void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {trace::release(p);} \
+    void operator delete(void* p, const std::nothrow_t&) noexcept {trace::release(p);} \
+    void operator delete[](void* p, const std::nothrow_t&) noexcept {trace::release(p);} \
+    void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {trace::release(p);} \
+    void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {trace::release(p);}
+
+#else
+
+#define TRACE_SCOPE(name) do{}while(0)
+#define TRACE_ADD(name, v) do{}while(0)
+#define TRACE_COUNT(name) do{}while(0)
+#define TRACE_MAX(name, v) do{}while(0)
+#define TRACE_ALLOCATIONS()
+
+#endif
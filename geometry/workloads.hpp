@@ -0,0 +1,106 @@
+// seeded generators of test inputs, the same (kind, n, seed) always gives the same points
+// (std::mt19937_64 is fully specified, the distributions are done by hand because std's differ between standard libraries)
+// points are flat coordinate arrays (x0,y0,x1,y1,...) inside [0,size]x[0,size], segments are (x1,y1,x2,y2,...)
+//  uniform:    uniformly random
+//  gaussian:   normal around the centre (sigma = size/8), dense core and a sparse fringe
+//  circle:     on a circle, an all-hull input and nearly cocircular for the sweeps
+//  collinear:  on one (slanted) line, degenerate for everything
+//  grid:       square lattice, lots of exactly cocircular quadruples and collinear runs
+//  long:       segments between two uniform points, O(n^2) intersections
+//  short:      segments about one average spacing long, O(n) intersections
+//  parallel:   all with the same slope, no intersections but a full status structure
+
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+class Workload{
+        std::mt19937_64 rng;
+
+        double uniform(){return (rng() >> 11) * (1.0/9007199254740992.0);}  // [0,1) with all 53 bits
+        double normal(){    // Box-Muller
+            double u = uniform(), v = uniform();
+            return std::sqrt(-2*std::log(1-u)) * std::cos(2*M_PI*v);
+        }
+
+    public:
+        double size;
+
+        Workload(uint64_t seed, double size = 1000) : rng(seed), size(size){}
+
+        static bool is_points(const char* kind){
+            for(auto k : {"uniform", "gaussian", "circle", "collinear", "grid"}){if(strcmp(kind, k) == 0){return true;}}
+            return false;
+        }
+        static bool is_segments(const char* kind){
+            for(auto k : {"long", "short", "parallel"}){if(strcmp(kind, k) == 0){return true;}}
+            return false;
+        }
+
+        // n points of the given kind, false if there's no such kind
+        bool points(const char* kind, std::size_t n, std::vector< double >& xy){
+            xy.resize(2*n);
+            double c = size/2;
+            if(strcmp(kind, "uniform") == 0){
+                for(auto& v : xy){v = uniform()*size;}
+            }else
+            if(strcmp(kind, "gaussian") == 0){
+                for(auto& v : xy){v = std::min(std::max(c + normal()*size/8, 0.0), size);}
+            }else
+            if(strcmp(kind, "circle") == 0){
+                for(std::size_t i=0; i<n; ++i){
+                    double a = uniform()*2*M_PI;
+                    xy[2*i] = c + c*std::cos(a);
+                    xy[2*i+1] = c + c*std::sin(a);
+                }
+            }else
+            if(strcmp(kind, "collinear") == 0){
+                for(std::size_t i=0; i<n; ++i){
+                    double t = uniform();
+                    xy[2*i] = t*size;
+                    xy[2*i+1] = size/4 + t*size/2;
+                }
+            }else
+            if(strcmp(kind, "grid") == 0){
+                std::size_t w = std::max< std::size_t >(1, std::ceil(std::sqrt((double)n)));
+                double step = size/w;
+                for(std::size_t i=0; i<n; ++i){
+                    xy[2*i] = (i%w)*step;
+                    xy[2*i+1] = (i/w)*step;
+                }
+            }else{
+                return false;
+            }
+            return true;
+        }
+
+        // n segments of the given kind, false if there's no such kind
+        bool segments(const char* kind, std::size_t n, std::vector< double >& s){
+            s.resize(4*n);
+            if(strcmp(kind, "long") == 0){
+                for(auto& v : s){v = uniform()*size;}
+            }else
+            if(strcmp(kind, "short") == 0){
+                double len = size/std::sqrt((double)std::max< std::size_t >(n, 1));
+                for(std::size_t i=0; i<n; ++i){
+                    double x = uniform()*size, y = uniform()*size, a = uniform()*2*M_PI;
+                    s[4*i] = x; s[4*i+1] = y;
+                    s[4*i+2] = x + len*std::cos(a); s[4*i+3] = y + len*std::sin(a);
+                }
+            }else
+            if(strcmp(kind, "parallel") == 0){
+                for(std::size_t i=0; i<n; ++i){
+                    double x = uniform()*size/2, y = uniform()*size, len = uniform()*size/2;
+                    s[4*i] = x; s[4*i+1] = y;
+                    s[4*i+2] = x + len; s[4*i+3] = y + len/3;
+                }
+            }else{
+                return false;
+            }
+            return true;
+        }
+};
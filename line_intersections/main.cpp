@@ -1,12 +1,75 @@
 // #include <iostream>
 
 #include <SFML/Graphics.hpp>
-#include <set>
 #include <vector>
-#include <cmath>
-#include <limits>
+#include <chrono>
 
-#include "algorithm.hpp"
+#include "../geometry/segments.hpp"
+#include "../geometry/progress.hpp"
+#include "../render/layer.hpp"
+#include "../render/worker.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+std::vector< segments::Line > input;    // the segments as clicked in, the sweep gets a copy
+Layer lines;    // the segments
+Layer intersections(2.f, 8.f, sf::Color::White, sf::Color::Blue);
+
+// the sweep runs on a worker thread (see render/worker.hpp), about once a frame it hands over what it has found so far
+struct Progress{
+    float sweep_y;
+    std::vector< sf::Vector2f > found;
+    bool done;
+};
+typedef Worker< Progress > SweepWorker;
+SweepWorker worker;
+float sweep_y = 0;
+bool sweeping = false;
+
+void add_line(float x1, float y1, float x2, float y2){
+    worker.stop();  // stale now
+    sweeping = false;
+    input.push_back(segments::Line(x1, y1, x2, y2, input.size()));
+    lines.add(x1, y1, x2, y2);
+}
+
+// on the worker: what segments::intersections has so far into the worker's draft, and hands it over
+void publish(SweepWorker& w, float y, bool done){
+    Progress& p = w.draft();
+    p.sweep_y = y;
+    p.done = done;
+    p.found.clear();
+    for(auto& e : segments::intersections){p.found.push_back(sf::Vector2f(e.at.x, e.at.y));}
+    w.publish();
+}
+
+void find_intersections(){
+    worker.start([copy = input](SweepWorker& w){
+        segments::lines = copy;
+        const auto frame = std::chrono::milliseconds(16);
+        auto last = Clock::now() - frame;   // the first report goes out right away
+        progress::Scope scope([&](double y){
+            if(w.cancelled()){return false;}
+            if(Clock::now() - last >= frame){
+                publish(w, y, false);
+                last = Clock::now();
+            }
+            return true;
+        });
+        segments::sweep_intersections();  // the sweep, whatever the size: this demo is about watching it
+        if(!w.cancelled()){publish(w, 0, true);}
+    });
+    sweeping = true;
+    sweep_y = 0;
+}
+
+void show(const Progress& p){
+    intersections.clear();
+    intersections.reserve(p.found.size());
+    for(auto& v : p.found){intersections.add(v.x, v.y);}
+    sweep_y = p.sweep_y;
+    sweeping = !p.done;
+}
 
 int main(){      
     sf::ContextSettings settings;
@@ -27,9 +90,7 @@ int main(){
                         x = event.mouseButton.x;
                         y = event.mouseButton.y;
                     }else{
-                        lines.push_back(Line(x,y,event.mouseButton.x, event.mouseButton.y));
-                        if(y < sweep_line_y){sweep_line_y = y;}
-                        if(event.mouseButton.y < sweep_line_y){sweep_line_y = event.mouseButton.y;}
+                        add_line(x, y, event.mouseButton.x, event.mouseButton.y);
                     }
                     flag = !flag;
                 }else
@@ -39,17 +100,29 @@ int main(){
             }
             if (event.type == sf::Event::KeyPressed){
                 if(event.key.code == sf::Keyboard::R){
+                    worker.stop();
+                    input.clear();
                     lines.clear();
                     intersections.clear();
+                    sweeping = false;
                     flag = false; 
                 }
             }
         }
 
+        if(auto p = worker.latest()){show(*p);}
+
         window.clear(sf::Color::Black);
-        for(auto l: lines){window.draw(l);}
-        for(auto i: intersections){window.draw(i);}
+        window.draw(lines);
+        window.draw(intersections);
+        if(sweeping){   // where the sweep line is, while it's still going
+            sf::Vertex line[2] = {
+                sf::Vertex(sf::Vector2f(0, sweep_y), sf::Color::Red),
+                sf::Vertex(sf::Vector2f(window.getSize().x, sweep_y), sf::Color::Red)
+            };
+            window.draw(line, 2, sf::Lines);
+        }
         window.display();
     }
     return 0;
-}
\ No newline at end of file
+}
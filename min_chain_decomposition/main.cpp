@@ -2,87 +2,130 @@
 #include <set>
 #include <vector>
 #include <iostream>
+#include <chrono>
+
+#include "../geometry/chains.hpp"
+#include "../render/layer.hpp"
+#include "../render/worker.hpp"
+
+typedef std::chrono::steady_clock Clock;
 
 #define EPSILON 1e-7
 #define CLOSE(a,b) (abs(a-b)<EPSILON)
 
-// "dot" referes to a mathematical point but drawn with a thickness, represented as an SFML circle
-// "vertex" refers to just the 1-pixel point, also an SFML vertex
-// programmatically convenient to draw() chain with vertex-array but visually convenient to draw() points with dots
+// the points are kept in a set (ordered, no duplicates) and drawn as dots from a layer next to it
 
-class Point : public sf::Drawable{
-        sf::CircleShape dot;
-        void draw(sf::RenderTarget& target, sf::RenderStates states) const {
-            target.draw(dot, states);
-        }
-    public:
-        sf::Vertex vertex;
-        Point(float x, float y){
-            float r = 2.f;
-            dot = sf::CircleShape(r, 10);
-            dot.setPosition(x-r,y-r);
-            dot.setFillColor(sf::Color::White);
-            dot.setOutlineThickness(2.f);
-            dot.setOutlineColor(sf::Color::Blue);
-            vertex = sf::Vertex(sf::Vector2f(x, y), sf::Color::White);
-        }
-        bool operator< (const Point& rhs) const{
-            if(!CLOSE(vertex.position.x, rhs.vertex.position.x)){
-                return vertex.position.x < rhs.vertex.position.x;
-            }else{
-                return vertex.position.y > rhs.vertex.position.y;
-            }
+struct Point{
+    float x;
+    float y;
+    bool operator< (const Point& rhs) const{
+        if(!CLOSE(x, rhs.x)){
+            return x < rhs.x;
+        }else{
+            return y > rhs.y;
         }
+    }
 };
 
-class Chain : public sf::Drawable{
-        std::vector<sf::Vertex> varray;
-        void draw(sf::RenderTarget& target, sf::RenderStates states) const {
-            target.draw(&varray[0], varray.size(), sf::LineStrip, states);
-        }
-    public:
-        Chain(sf::Vertex first){
-            varray.push_back(first);
-        }
-        void add(Point& p) {
-            varray.push_back(p.vertex);
-        }
-        bool operator< (const Chain& rhs) const{                        // chain < chain
-            return varray.back().position.y < rhs.varray.back().position.y;
-        }
-        bool operator< (const Point& rhs) const{                        // chain < point
-            return varray.back().position.y < rhs.vertex.position.y;
-        }
-        friend bool operator< (const Point& lhs, const Chain& rhs) {    // point < chain
-            return lhs.vertex.position.y < rhs.varray.back().position.y;
-        }
+std::set< Point > points;
+Layer dots(2.f, 2.f, sf::Color::White, sf::Color::Blue);
+Layer chain_lines;   // every link of every chain as one segment
+Layer antichain_dots(5.f, 2.f, sf::Color::Transparent, sf::Color::Red);  // a largest antichain, proof that no fewer chains would do
+Layer layer_lines;   // staircases of the maxima layers
+
+// the chains are built on a worker thread (see render/worker.hpp), about once a frame it hands over the links made so far
+// (the points are added left to right, so that's everything left of the sweep line), the layers and antichain at the end
+struct Progress{
+    float sweep_x;
+    std::vector< sf::Vector2f > links, steps;   // two ends per chain link and per staircase step
+    std::vector< sf::Vector2f > antichain;
+    bool done;
 };
+typedef Worker< Progress > ChainWorker;
+ChainWorker worker;
+float sweep_x = 0;
+bool sweeping = false;
 
-std::set< Point > points;
-std::set< Chain, std::less<> > chains;
+// on the worker: the links of chains into p
+void add_links(const ChainDecomposition& chains, Progress& p){
+    p.links.clear();
+    for(int i=0; i<chains.size(); ++i){
+        int j = chains.next[i];
+        if(j < 0){continue;}
+        p.links.push_back(sf::Vector2f(chains.xs[i], chains.ys[i]));
+        p.links.push_back(sf::Vector2f(chains.xs[j], chains.ys[j]));
+    }
+}
 
 void make_chains(){
-    chains.clear();
-    for(auto p: points){
-        if(chains.empty()){
-            chains.insert(Chain(p.vertex));
-            continue;
+    std::vector< ChainPoint > sorted;
+    for(auto& p: points){sorted.push_back(ChainPoint{p.x, p.y});}
+    worker.start([sorted = std::move(sorted)](ChainWorker& w){
+        ChainDecomposition chains;
+        chains.reserve(sorted.size());
+        const auto frame = std::chrono::milliseconds(16);
+        auto last = Clock::now() - frame;   // the first report goes out right away
+        for(std::size_t k=0; k<sorted.size(); ++k){
+            chains.add(sorted[k].x, sorted[k].y);
+            if(k & 255){continue;}
+            if(w.cancelled()){return;}
+            if(Clock::now() - last >= frame){
+                Progress& p = w.draft();
+                p.sweep_x = sorted[k].x;
+                p.done = false;
+                add_links(chains, p);
+                p.steps.clear();
+                p.antichain.clear();
+                w.publish();
+                last = Clock::now();
+            }
         }
 
-        auto it = chains.upper_bound(p);    // highest chain able to accept p
-        if(it == chains.end()){
-            chains.insert(Chain(p.vertex));
-        }else{
-            auto chain = *it;
-            chain.add(p);   // should update in-place but std::set doesn't allow it since it doesn't know that in this case order never changes on updating a chain
-            chains.erase(it); chains.insert(chain); // therefore an inefficiency (should only need the one 'log_n' traversal with call to upper_bound() )
+        Progress& p = w.draft();
+        p.done = true;
+        add_links(chains, p);
+
+        // maxima layers, each one drawn as the staircase through its points (left to right: across, then down to the next)
+        std::vector< int > layer;
+        int layers = maxima_layers(sorted, layer);
+        std::vector< int > prev(layers, -1);
+        p.steps.clear();
+        for(int i=0; i<(int)sorted.size(); ++i){
+            int j = prev[layer[i]];
+            prev[layer[i]] = i;
+            if(j < 0){continue;}
+            sf::Vector2f corner(sorted[i].x, sorted[j].y);
+            p.steps.push_back(sf::Vector2f(sorted[j].x, sorted[j].y));
+            p.steps.push_back(corner);
+            p.steps.push_back(corner);
+            p.steps.push_back(sf::Vector2f(sorted[i].x, sorted[i].y));
         }
-    }
+
+        p.antichain.clear();
+        for(int q : chains.antichain()){p.antichain.push_back(sf::Vector2f(chains.xs[q], chains.ys[q]));}
+        if(!w.cancelled()){w.publish();}
+    });
+    sweeping = true;
+    sweep_x = 0;
 }
 
+void show(const Progress& p){
+    chain_lines.clear();
+    for(std::size_t i=0; i+1<p.links.size(); i+=2){chain_lines.add(p.links[i].x, p.links[i].y, p.links[i+1].x, p.links[i+1].y);}
+    layer_lines.clear();
+    for(std::size_t i=0; i+1<p.steps.size(); i+=2){
+        layer_lines.add(p.steps[i].x, p.steps[i].y, p.steps[i+1].x, p.steps[i+1].y, sf::Color::Green, sf::Color::Green);
+    }
+    antichain_dots.clear();
+    for(auto& v : p.antichain){antichain_dots.add(v.x, v.y);}
+    sweep_x = p.sweep_x;
+    sweeping = !p.done;
+}
 
 int main(){      
     bool display_chains = true;
+    bool display_antichain = false;
+    bool display_layers = false;
     
     sf::ContextSettings settings;
     settings.antialiasingLevel = 6;
@@ -94,7 +137,10 @@ int main(){
             if (event.type == sf::Event::Closed){window.close();}
             if (event.type == sf::Event::MouseButtonPressed){
                 if(event.mouseButton.button == sf::Mouse::Left){
-                    points.insert(Point(event.mouseButton.x, event.mouseButton.y));
+                    worker.stop();  // stale now
+                    sweeping = false;
+                    Point p{(float)event.mouseButton.x, (float)event.mouseButton.y};
+                    if(points.insert(p).second){dots.add(p.x, p.y);}
                 }else
                 if(event.mouseButton.button == sf::Mouse::Right){
                     make_chains();
@@ -102,21 +148,41 @@ int main(){
             }
             if (event.type == sf::Event::KeyPressed){
                 if(event.key.code == sf::Keyboard::R){
+                    worker.stop();
+                    sweeping = false;
                     points.clear();
-                    chains.clear();
+                    dots.clear();
+                    chain_lines.clear();
+                    antichain_dots.clear();
+                    layer_lines.clear();
                 }else
                 if (event.key.code == sf::Keyboard::H){
                     display_chains = !display_chains;
+                }else
+                if (event.key.code == sf::Keyboard::A){
+                    display_antichain = !display_antichain;
+                }else
+                if (event.key.code == sf::Keyboard::L){
+                    display_layers = !display_layers;
                 }
             }
         }
 
+        if(auto p = worker.latest()){show(*p);}
+
         window.clear(sf::Color::Black);
         
-        for(auto p: points){window.draw(p);}
+        window.draw(dots);
         
-        if(display_chains){
-        for(auto c: chains){window.draw(c);}
+        if(display_chains){window.draw(chain_lines);}
+        if(display_layers){window.draw(layer_lines);}
+        if(display_antichain){window.draw(antichain_dots);}
+        if(sweeping){   // how far left to right the chains are, while they're still being built
+            sf::Vertex line[2] = {
+                sf::Vertex(sf::Vector2f(sweep_x, 0), sf::Color::Red),
+                sf::Vertex(sf::Vector2f(sweep_x, window.getSize().y), sf::Color::Red)
+            };
+            window.draw(line, 2, sf::Lines);
         }
         
         window.display();
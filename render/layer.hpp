@@ -0,0 +1,171 @@
+// batched drawing for the demos: everything of one kind (the input dots, the result's segments...) is one Layer, drawn with
+// a single draw call from one vertex batch that is only rebuilt when the layer's contents or the view change
+// when it is rebuilt, whatever is outside the view is culled and whatever would land on an already covered spot is
+// decimated: dots on a grid of cells one dot radius wide (the dots there would all overlap anyway), segments shorter
+// than a pixel on a grid of pixels. so a batch never grows past what the window can show, however many items there are,
+// and a frame where nothing changed costs one draw call no matter how many there are
+// the batch lives in an sf::VertexBuffer (on the GPU) where those are supported, in a plain vertex array otherwise
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+class Layer : public sf::Drawable{
+    public:
+        enum Kind{Dots, Lines};
+
+    private:
+        Kind kind;
+        float radius, thickness;    // dots: radius of the fill and thickness of the outline around it, in pixels
+        sf::Color fill, outline;
+        std::vector< sf::Vertex > items;    // dots: one vertex (the centre) per dot, lines: two per segment
+
+        mutable std::vector< sf::Vertex > batch;
+        mutable sf::VertexBuffer buffer;
+        mutable std::size_t capacity = 0;   // vertices the buffer was created for
+        mutable bool dirty = true;
+        mutable sf::Vector2f seen_center, seen_size;    // the view and target size the batch was built for
+        mutable sf::Vector2u seen_target;
+        mutable std::vector< uint64_t > covered;        // one bit per decimation cell
+
+        // is the cell (i,j) of a w wide grid taken already? takes it if not
+        bool take(std::size_t i, std::size_t j, std::size_t w) const {
+            std::size_t b = j*w + i;
+            uint64_t bit = uint64_t(1) << (b & 63);
+            if(covered[b >> 6] & bit){return true;}
+            covered[b >> 6] |= bit;
+            return false;
+        }
+
+        // a regular hexagon fan (filled) or ring (outline) around c, as triangles
+        void hexagon(sf::Vector2f c, float r_in, float r_out, float sx, float sy, sf::Color color) const {
+            static const float cs[7] = {1, 0.5f, -0.5f, -1, -0.5f, 0.5f, 1};
+            static const float sn[7] = {0, 0.8660254f, 0.8660254f, 0, -0.8660254f, -0.8660254f, 0};
+            for(int k=0; k<6; ++k){
+                sf::Vector2f o1(c.x + r_out*sx*cs[k], c.y + r_out*sy*sn[k]);
+                sf::Vector2f o2(c.x + r_out*sx*cs[k+1], c.y + r_out*sy*sn[k+1]);
+                if(r_in <= 0){
+                    batch.push_back(sf::Vertex(c, color));
+                    batch.push_back(sf::Vertex(o1, color));
+                    batch.push_back(sf::Vertex(o2, color));
+                    continue;
+                }
+                sf::Vector2f i1(c.x + r_in*sx*cs[k], c.y + r_in*sy*sn[k]);
+                sf::Vector2f i2(c.x + r_in*sx*cs[k+1], c.y + r_in*sy*sn[k+1]);
+                batch.push_back(sf::Vertex(i1, color));
+                batch.push_back(sf::Vertex(o1, color));
+                batch.push_back(sf::Vertex(o2, color));
+                batch.push_back(sf::Vertex(i1, color));
+                batch.push_back(sf::Vertex(o2, color));
+                batch.push_back(sf::Vertex(i2, color));
+            }
+        }
+
+        void rebuild(const sf::RenderTarget& target) const {
+            const sf::View& view = target.getView();
+            seen_center = view.getCenter();
+            seen_size = view.getSize();
+            seen_target = target.getSize();
+            dirty = false;
+            batch.clear();
+            if(seen_size.x <= 0 || seen_size.y <= 0 || seen_target.x == 0 || seen_target.y == 0){return;}
+
+            // world units per pixel, and the visible rectangle (grown by a dot so ones on the border aren't cut off)
+            float sx = seen_size.x/seen_target.x, sy = seen_size.y/seen_target.y;
+            float reach = (kind == Dots) ? radius + thickness : 1;
+            float x0 = seen_center.x - seen_size.x/2 - reach*sx, x1 = seen_center.x + seen_size.x/2 + reach*sx;
+            float y0 = seen_center.y - seen_size.y/2 - reach*sy, y1 = seen_center.y + seen_size.y/2 + reach*sy;
+
+            float cell = (kind == Dots) ? std::max(1.f, radius) : 1;    // decimation cell, in pixels
+            std::size_t w = (x1-x0)/sx/cell + 1, h = (y1-y0)/sy/cell + 1;
+            covered.assign((w*h + 63)/64, 0);
+            auto cell_x = [&](float x){return std::min< std::size_t >((x-x0)/sx/cell, w-1);};
+            auto cell_y = [&](float y){return std::min< std::size_t >((y-y0)/sy/cell, h-1);};
+
+            if(kind == Dots){
+                for(auto& v : items){
+                    auto p = v.position;
+                    if(p.x < x0 || p.x > x1 || p.y < y0 || p.y > y1){continue;}
+                    if(take(cell_x(p.x), cell_y(p.y), w)){continue;}
+                    if(fill.a > 0){hexagon(p, 0, radius, sx, sy, fill);}
+                    if(thickness > 0 && outline.a > 0){hexagon(p, radius, radius+thickness, sx, sy, outline);}
+                }
+            }else{
+                for(std::size_t k=0; k+1<items.size(); k+=2){
+                    if(items[k].color.a == 0 && items[k+1].color.a == 0){continue;}     // an empty slot, see hide()
+                    auto a = items[k].position, b = items[k+1].position;
+                    if(std::max(a.x, b.x) < x0 || std::min(a.x, b.x) > x1 || std::max(a.y, b.y) < y0 || std::min(a.y, b.y) > y1){continue;}
+                    bool tiny = std::abs(a.x-b.x) < sx && std::abs(a.y-b.y) < sy;
+                    if(tiny && a.x >= x0 && a.x <= x1 && a.y >= y0 && a.y <= y1 && take(cell_x(a.x), cell_y(a.y), w)){continue;}
+                    batch.push_back(items[k]);
+                    batch.push_back(items[k+1]);
+                }
+            }
+
+            if(sf::VertexBuffer::isAvailable() && !batch.empty()){
+                if(batch.size() > capacity){
+                    capacity = std::max(batch.size(), 2*capacity);
+                    buffer.create(capacity);
+                }
+                buffer.update(batch.data(), batch.size(), 0);
+            }
+        }
+
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const {
+            const sf::View& view = target.getView();
+            auto c = view.getCenter(), s = view.getSize();
+            auto t = target.getSize();
+            if(dirty || c.x != seen_center.x || c.y != seen_center.y || s.x != seen_size.x || s.y != seen_size.y || t.x != seen_target.x || t.y != seen_target.y){
+                rebuild(target);
+            }
+            if(batch.empty()){return;}
+            if(sf::VertexBuffer::isAvailable()){
+                target.draw(buffer, 0, batch.size(), states);
+            }else{
+                target.draw(batch.data(), batch.size(), kind == Dots ? sf::Triangles : sf::Lines, states);
+            }
+        }
+
+    public:
+        // dots of the given radius (fill) and outline thickness in pixels, they stay that size when the view zooms
+        Layer(float radius, float thickness, sf::Color fill, sf::Color outline)
+            : kind(Dots), radius(radius), thickness(thickness), fill(fill), outline(outline),
+              buffer(sf::Triangles, sf::VertexBuffer::Dynamic){}
+        // segments, coloured per end
+        Layer() : kind(Lines), radius(0), thickness(0), buffer(sf::Lines, sf::VertexBuffer::Dynamic){}
+
+        void clear(){items.clear(); dirty = true;}
+        void reserve(std::size_t n){items.reserve(kind == Dots ? n : 2*n);}
+        std::size_t size() const {return kind == Dots ? items.size() : items.size()/2;}
+        bool empty() const {return items.empty();}
+        // vertices in the batch the last time it was drawn (after culling and decimation)
+        std::size_t drawn() const {return batch.size();}
+
+        void add(float x, float y){
+            items.push_back(sf::Vertex(sf::Vector2f(x, y)));
+            dirty = true;
+        }
+        void add(float x1, float y1, float x2, float y2, sf::Color c1 = sf::Color::White, sf::Color c2 = sf::Color::White){
+            items.push_back(sf::Vertex(sf::Vector2f(x1, y1), c1));
+            items.push_back(sf::Vertex(sf::Vector2f(x2, y2), c2));
+            dirty = true;
+        }
+
+        // segments kept in fixed slots (one per triangle edge, say) that are rewritten in place as things change:
+        // set() puts segment k there (growing the layer to hold it, the slots in between stay empty), hide() empties it
+        void set(std::size_t k, float x1, float y1, float x2, float y2, sf::Color c1 = sf::Color::White, sf::Color c2 = sf::Color::White){
+            if(2*k+2 > items.size()){items.resize(2*k+2, sf::Vertex(sf::Vector2f(0, 0), sf::Color::Transparent));}
+            items[2*k] = sf::Vertex(sf::Vector2f(x1, y1), c1);
+            items[2*k+1] = sf::Vertex(sf::Vector2f(x2, y2), c2);
+            dirty = true;
+        }
+        void hide(std::size_t k){
+            if(2*k+1 >= items.size()){return;}
+            items[2*k].color = items[2*k+1].color = sf::Color::Transparent;
+            dirty = true;
+        }
+};
@@ -0,0 +1,70 @@
+// runs the demos' algorithms on a thread of their own, so the window keeps drawing (and taking clicks) while they work
+// one job at a time: start() cancels the one that's running, whose result would be stale anyway, and waits for it to stop
+// (the algorithms check for that every few hundred steps, see geometry/progress.hpp, so that's well under a frame)
+// while it runs, the job fills draft() with what it has so far and publish()es it, the render loop takes the newest
+// snapshot with latest() once per frame. the two meet in a triple buffer: one slot the job writes, one the render loop
+// reads and one in between that they swap with a single atomic exchange, so neither ever waits for the other
+// every job and the render loop only touch the algorithm's globals from one side: the job owns them while it runs
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+template< typename Snapshot >
+class Worker{
+        static const int FRESH = 4;             // set in middle when it holds a snapshot the reader hasn't taken yet
+
+        Snapshot slots[3];
+        int back = 0;                           // the job's slot
+        std::atomic< int > middle{1};
+        int front = 2;                          // the render loop's slot
+        std::atomic< bool > cancel{false};
+        std::atomic< bool > running{false};
+        std::thread thread;
+
+    public:
+        Worker(){}
+        Worker(const Worker&) = delete;
+        Worker& operator=(const Worker&) = delete;
+        ~Worker(){stop();}
+
+        // cancels the running job (if any) and waits for it, then runs job(*this) on a new thread
+        template< typename Job >
+        void start(Job job){
+            stop();
+            cancel = false;
+            running = true;
+            thread = std::thread([this, job]() mutable {
+                job(*this);
+                running = false;
+            });
+        }
+        // cancels the running job (if any) and waits for it, what it published and wasn't taken yet is dropped
+        void stop(){
+            cancel = true;
+            if(thread.joinable()){thread.join();}
+            middle.store(middle.load() & ~FRESH);
+            running = false;
+        }
+
+        // for the render loop: is a job still going
+        bool busy() const {return running;}
+
+        // for the job: should it give up
+        bool cancelled() const {return cancel.load(std::memory_order_relaxed);}
+        // for the job: the snapshot to fill (it's an older one, overwrite all of it), then hand it over with publish()
+        Snapshot& draft(){return slots[back];}
+        void publish(){
+            back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+        }
+
+        // for the render loop: the newest snapshot if one came in since the last call, nullptr otherwise
+        // (it stays valid until the next call)
+        const Snapshot* latest(){
+            if(!(middle.load(std::memory_order_acquire) & FRESH)){return nullptr;}
+            front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+            return &slots[front];
+        }
+};
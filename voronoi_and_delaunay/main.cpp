@@ -6,8 +6,264 @@
 #include <iostream>
 #include <cmath>
 #include <unordered_set>
+#include <chrono>
 
-#include "algorithm.hpp"
+#include "../geometry/loader.hpp"
+#include "../geometry/fortune.hpp"
+#include "../geometry/incremental.hpp"
+#include "../geometry/nearest.hpp"
+#include "../geometry/lloyd.hpp"
+#include "../geometry/graphs.hpp"
+#include "../geometry/progress.hpp"
+#include "../render/layer.hpp"
+#include "../render/worker.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+bool show_delaunay = true;
+bool show_voronoi = true;
+
+std::vector< double > points;  // x0,y0,x1,y1,... in click/input order
+Layer dots(2.f, 2.f, sf::Color::White, sf::Color::Blue);
+
+void add_point(double x, double y){
+    points.push_back(x);
+    points.push_back(y);
+    dots.add(x, y);
+}
+
+// the diagram from the sweep (geometry/fortune.hpp), computed on right click and dropped as soon as a point is added
+Layer sweep_voronoi;
+Layer sweep_delaunay;
+
+// the sweep runs on a worker thread (see render/worker.hpp), about once a frame it hands over the part of the diagram the
+// sweep line has passed, which is drawn (with the sweep line) until the whole diagram is in
+struct Progress{
+    float sweep_y;
+    std::vector< sf::Vector2f > voronoi, delaunay;  // two ends per edge
+    bool done;
+};
+typedef Worker< Progress > SweepWorker;
+SweepWorker worker;
+float sweep_y = 0;
+bool sweeping = false;
+
+// on the worker: fortune::D so far into the worker's draft, and hands it over
+void publish(SweepWorker& w, float y, bool done){
+    Progress& p = w.draft();
+    p.sweep_y = y;
+    p.done = done;
+    p.voronoi.clear();
+    p.delaunay.clear();
+    for(auto& e : fortune::D){
+        auto& a = fortune::sites[e.p1];
+        auto& b = fortune::sites[e.p2];
+        p.voronoi.push_back(sf::Vector2f(e.x1, e.y1));
+        p.voronoi.push_back(sf::Vector2f(e.x2, e.y2));
+        p.delaunay.push_back(sf::Vector2f(a.x, a.y));
+        p.delaunay.push_back(sf::Vector2f(b.x, b.y));
+    }
+    w.publish();
+}
+
+void sweep(){
+    worker.start([copy = points](SweepWorker& w){
+        const auto frame = std::chrono::milliseconds(16);
+        auto last = Clock::now() - frame;   // the first report goes out right away
+        progress::Scope scope([&](double y){
+            if(w.cancelled()){return false;}
+            if(Clock::now() - last >= frame){
+                publish(w, y, false);
+                last = Clock::now();
+            }
+            return true;
+        });
+        fortune::voronoi(copy);
+        if(!w.cancelled()){publish(w, 0, true);}
+    });
+    sweeping = true;
+    sweep_y = 0;
+}
+
+void show_sweep(const Progress& p){
+    sweep_voronoi.clear();
+    sweep_delaunay.clear();
+    for(std::size_t i=0; i+1<p.voronoi.size(); i+=2){
+        sweep_voronoi.add(p.voronoi[i].x, p.voronoi[i].y, p.voronoi[i+1].x, p.voronoi[i+1].y);
+        sweep_delaunay.add(p.delaunay[i].x, p.delaunay[i].y, p.delaunay[i+1].x, p.delaunay[i+1].y, sf::Color(0,255, 255, 50), sf::Color(0,255, 255, 200));
+    }
+    sweep_y = p.sweep_y;
+    sweeping = !p.done;
+}
+
+void drop_sweep(){
+    worker.stop();  // a sweep that's still going is stale too
+    sweeping = false;
+    sweep_voronoi.clear();
+    sweep_delaunay.clear();
+}
+
+// live diagram, updated one site at a time as points are clicked in (the sweep only runs on right click)
+Triangulation live;
+Layer live_voronoi;
+Layer live_delaunay;
+
+// nearest site to the mouse cursor (toggled with N), the query index is rebuilt lazily when the diagram changes
+bool show_nearest = false;
+bool nearest_stale = true;
+NearestSite nearest(live);
+
+// euclidean minimum spanning tree of the live sites (toggled with M), kept up to date by insert_live() while it's shown,
+// edge k of the tree in slot k of the layer
+bool show_emst = false;
+IncrementalEmst tree(live);
+Layer live_emst;
+
+void draw_tree_edge(int k){
+    auto& a = live.site(tree.edge(k).first);
+    auto& b = live.site(tree.edge(k).second);
+    live_emst.set(k, a.x, a.y, b.x, b.y, sf::Color::Magenta, sf::Color::Magenta);
+}
+
+// from emst(live), or from the tree given if that's been computed already
+void rebuild_emst(const Graph* g = nullptr){
+    live_emst.clear();
+    if(!show_emst){return;}
+    if(g){tree.reset(*g);}
+    else{tree.reset();}
+    for(int k=0; k<tree.size(); ++k){draw_tree_edge(k);}
+}
+
+// one slot per triangle edge in the live layers, slot 3t+i is the edge of triangle t opposite its vertex i: drawn by the
+// lower numbered of the two triangles that share it (like delaunay_edges() does), left empty by the other one, and by
+// dead triangles and edges to the super-triangle
+void draw_triangle(int t){
+    auto& T = live.tris[t];
+    for(int i=0; i<3; ++i){
+        int a = T.v[(i+1)%3], b = T.v[(i+2)%3], nb = T.n[i];
+        if(!T.alive || live.is_super(a) || live.is_super(b) || (nb >= 0 && nb < t)){
+            live_voronoi.hide(3*t+i);
+            live_delaunay.hide(3*t+i);
+            continue;
+        }
+        auto& p = live.sites[a];
+        auto& q = live.sites[b];
+        live_delaunay.set(3*t+i, p.x, p.y, q.x, q.y, sf::Color(0,255, 255, 50), sf::Color(0,255, 255, 200));
+        if(nb < 0){live_voronoi.hide(3*t+i); continue;}
+        auto c = live.circumcenter(t), d = live.circumcenter(nb);
+        live_voronoi.set(3*t+i, c.x, c.y, d.x, d.y);
+    }
+}
+
+// everything over, after the sites changed all at once
+void refresh_live(const Graph* g = nullptr){
+    live_voronoi.clear();
+    live_delaunay.clear();
+    for(int t=0; t<(int)live.tris.size(); ++t){draw_triangle(t);}
+    rebuild_emst(g);
+    nearest_stale = true;
+}
+
+// one more site, only the triangles the insertion touched are drawn over (and the tree's edges it replaced)
+void insert_live(double x, double y){
+    int before = live.size();
+    live.insert(x, y);
+    if(live.size() == before){return;}     // a duplicate, or off the map
+    for(int t : live.removed()){draw_triangle(t);}
+    for(int t : live.created()){
+        draw_triangle(t);
+        if(live.tris[t].n[0] >= 0){draw_triangle(live.tris[t].n[0]);}
+    }
+    if(show_emst){
+        for(int k : tree.update()){draw_tree_edge(k);}
+    }
+    nearest_stale = true;
+}
+
+// a Lloyd step (L) runs on a worker as well: every site moves to the centroid of its cell, and the moved sites come back
+// triangulated (with their tree, if it's shown) to replace the live diagram in one go
+// clicks don't wait for it, they bump edits and whatever step started before that is stale when it comes in
+struct Relaxed{
+    std::vector< double > sites;
+    Triangulation tr;
+    bool with_tree;
+    Graph tree;
+    int edits;
+};
+typedef Worker< Relaxed > LloydWorker;
+LloydWorker relaxer;
+int edits = 0;
+
+void relax(int window_x, int window_y){
+    relaxer.start([copy = points, window_x, window_y, with_tree = show_emst, edits = edits](LloydWorker& w){
+        Lloyd lloyd(copy, 0, 0, window_x, window_y);
+        lloyd.step();
+        if(w.cancelled()){return;}
+        Relaxed& r = w.draft();
+        r.sites = lloyd.sites();
+        r.tr = Triangulation(0, 0, window_x, window_y);
+        std::vector< int > handles;
+        r.tr.insert_all(r.sites, handles);
+        r.with_tree = with_tree;
+        if(with_tree){r.tree = emst(r.tr);}
+        r.edits = edits;
+        w.publish();
+    });
+}
+
+void take_relaxed(const Relaxed& r){
+    if(r.edits != edits){return;}
+    points.clear();
+    dots.clear();
+    for(std::size_t i=0; i+1<r.sites.size(); i+=2){add_point(r.sites[i], r.sites[i+1]);}
+    live = r.tr;
+    drop_sweep();
+    refresh_live(r.with_tree ? &r.tree : nullptr);
+}
+
+// Helper function to read from stdin (text or binary, see loader.hpp). you're welcome
+void read_from_stdin(int window_x, int window_y){
+    if(isatty(0)){
+        std::cout << "enter number of points, then that many lines of space separated coordinates (end input with Ctrl-D)" << std::endl;
+    }
+
+    /*
+        i smell a lack of comments, 
+        "for you see it is not important for the main program, this is just a helper function my lad",
+        said the programmer.
+        "But what does it do?"
+        "It helps me to not think about what it does by doing it"
+    */
+    std::vector< double > xy;
+    if(!load_points(0, xy)){
+        std::cerr << "could not read the points from stdin" << std::endl;
+        return;
+    }
+    int N = xy.size()/2;
+    double x_max = -fortune::K::inf(), x_min = fortune::K::inf(), y_max = -fortune::K::inf(), y_min = fortune::K::inf();
+    for(int i=0; i<N; ++i){
+        double x = xy[2*i], y = xy[2*i+1];
+        if(x>x_max){x_max = x;} if(x<x_min){x_min = x;}
+        if(y>y_max){y_max = y;} if(y<y_min){y_min = y;}
+    }
+    double del_y = y_max-y_min, del_x = x_max-x_min;
+    if(del_x*window_y > del_y*window_x){
+        double c = (del_x*window_y/window_x - del_y)/2;
+        y_min -= c; y_max += c;
+    }else
+    if(del_x*window_y < del_y*window_x){
+        double c = (del_y*window_x/window_y - del_x)/2;
+        x_min -= c; x_max += c;
+    }
+    del_y = y_max-y_min, del_x = x_max-x_min;
+    double xmargin = 0.5, ymargin = 0.5;
+    y_max += del_y*ymargin; y_min -= del_y*ymargin; x_max += del_x*xmargin; x_min -= del_x*xmargin;
+    double x_ = window_x/((1+2*xmargin)*del_x);
+    double y_ = window_y/((1+2*ymargin)*del_y);
+    points.reserve(2*N);
+    dots.reserve(N);
+    for(int i=0; i<N; ++i){add_point((xy[2*i]-x_min)*x_, (y_max-xy[2*i+1])*y_);}
+}
 
 int main(int argc, char**argv){
     
@@ -17,6 +273,10 @@ int main(int argc, char**argv){
     if(argc > 1){ // read a set of points from std::cin (or a file dumped into stdin)
         read_from_stdin(window_x, window_y);
     }
+    live = Triangulation(0, 0, window_x, window_y);
+    std::vector< int > handles;
+    live.insert_all(points, handles);
+    refresh_live();
     
     sf::ContextSettings settings;
     settings.antialiasingLevel = 6;
@@ -28,18 +288,23 @@ int main(int argc, char**argv){
             if (event.type == sf::Event::Closed){window.close();}
             if (event.type == sf::Event::MouseButtonPressed){
                 if(event.mouseButton.button == sf::Mouse::Left){
-                    points.push_back(Point(event.mouseButton.x, event.mouseButton.y));
+                    add_point(event.mouseButton.x, event.mouseButton.y);
+                    ++edits;
+                    drop_sweep();   // stale, fall back to drawing the live diagram
+                    insert_live(event.mouseButton.x, event.mouseButton.y);
                 }else
                 if(event.mouseButton.button == sf::Mouse::Right){
-                    voronoi();
+                    sweep();
                 }
             }
             if (event.type == sf::Event::KeyPressed){
                 if(event.key.code == sf::Keyboard::R){
                     points.clear();
-                    Q.clear();
-                    T.clear();
-                    D.clear();
+                    dots.clear();
+                    ++edits;
+                    drop_sweep();
+                    live.clear();
+                    refresh_live();
                 }
                 if(event.key.code == sf::Keyboard::D){
                     show_delaunay = !show_delaunay;
@@ -47,13 +312,56 @@ int main(int argc, char**argv){
                 if(event.key.code == sf::Keyboard::V){
                     show_voronoi = !show_voronoi;
                 }
+                if(event.key.code == sf::Keyboard::N){
+                    show_nearest = !show_nearest;
+                }
+                if(event.key.code == sf::Keyboard::M){
+                    show_emst = !show_emst;
+                    rebuild_emst();
+                }
+                if(event.key.code == sf::Keyboard::L && !points.empty() && !relaxer.busy()){ // one Lloyd step (unless one is going already)
+                    relax(window_x, window_y);
+                }
             }
         }
 
+        if(auto p = worker.latest()){show_sweep(*p);}
+        if(auto r = relaxer.latest()){take_relaxed(*r);}
+
         window.clear(sf::Color::Black);
         
-        for(auto& p: points){window.draw(p);}
-        for(auto& l: D){window.draw(l);}
+        window.draw(dots);
+        if(!sweep_delaunay.empty()){
+            if(show_voronoi){window.draw(sweep_voronoi);}
+            if(show_delaunay){window.draw(sweep_delaunay);}
+        }else{
+            if(show_voronoi){window.draw(live_voronoi);}
+            if(show_delaunay){window.draw(live_delaunay);}
+        }
+        if(show_emst){window.draw(live_emst);}
+        if(sweeping){   // where the sweep line is, while it's still going
+            sf::Vertex line[2] = {
+                sf::Vertex(sf::Vector2f(0, sweep_y), sf::Color::Red),
+                sf::Vertex(sf::Vector2f(window_x, sweep_y), sf::Color::Red)
+            };
+            window.draw(line, 2, sf::Lines);
+        }
+        
+        if(show_nearest){
+            if(nearest_stale){
+                nearest = NearestSite(live);
+                nearest_stale = false;
+            }
+            auto mouse = sf::Mouse::getPosition(window);
+            int h = nearest.query(mouse.x, mouse.y);
+            if(h >= 0){
+                sf::Vertex pointer[2] = {
+                    sf::Vertex(sf::Vector2f(mouse.x, mouse.y), sf::Color::Yellow),
+                    sf::Vertex(sf::Vector2f(live.site(h).x, live.site(h).y), sf::Color::Yellow)
+                };
+                window.draw(pointer, 2, sf::Lines);
+            }
+        }
         
         window.display();
     }